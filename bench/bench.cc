@@ -0,0 +1,337 @@
+// Throughput of each part of the pipeline on generated sources of different shapes.
+// usage: bench [filter] [--size=bytes] [--min-time=seconds] [--repetitions=count] [--seed=seed]
+//              [--corpus=file] [--json=file] [--baseline=file] [--update-baseline] [--threshold=fraction]
+// With --corpus the sources are generated from the entries in the file instead of one per shape.
+// With --baseline the run is compared to the stored results and fails if anything got slower,
+// a missing baseline or --update-baseline stores the run as the new baseline.
+// A missing baseline exits with 77 so test runners can report the run as skipped rather than passed.
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "fmt/core.h"
+#include "generate.h"
+#include "infofile/infofile.h"
+#include "infofile/lexer.h"
+#include "infofile/printstring.h"
+#include "infofile/reader.h"
+#include "regression.h"
+
+namespace
+{
+    struct Arguments
+    {
+        std::string filter;
+        std::size_t size = 1024 * 1024;
+        std::uint64_t seed = 42;
+        bench::BenchmarkOptions options;
+
+        std::string corpus;
+        std::string json;
+        std::string baseline;
+        bool update_baseline = false;
+        double threshold = 0.1;
+    };
+
+    bool StartsWith(const std::string& str, const std::string& prefix)
+    {
+        return str.compare(0, prefix.size(), prefix) == 0;
+    }
+
+    bool ParseArguments(int argc, char** argv, Arguments* args)
+    {
+        for (int i = 1; i < argc; i += 1)
+        {
+            const std::string arg = argv[i];
+            const auto value = arg.substr(arg.find('=') + 1);
+            if (StartsWith(arg, "--size="))
+            {
+                args->size = std::stoul(value);
+            }
+            else if (StartsWith(arg, "--min-time="))
+            {
+                args->options.min_seconds = std::stod(value);
+            }
+            else if (StartsWith(arg, "--repetitions="))
+            {
+                args->options.repetitions = std::stoi(value);
+            }
+            else if (StartsWith(arg, "--seed="))
+            {
+                args->seed = std::stoull(value);
+            }
+            else if (StartsWith(arg, "--corpus="))
+            {
+                args->corpus = value;
+            }
+            else if (StartsWith(arg, "--json="))
+            {
+                args->json = value;
+            }
+            else if (StartsWith(arg, "--baseline="))
+            {
+                args->baseline = value;
+            }
+            else if (arg == "--update-baseline")
+            {
+                args->update_baseline = true;
+            }
+            else if (StartsWith(arg, "--threshold="))
+            {
+                args->threshold = std::stod(value);
+            }
+            else if (StartsWith(arg, "--"))
+            {
+                std::cerr << "Unknown option " << arg << "\n";
+                return false;
+            }
+            else
+            {
+                args->filter = arg;
+            }
+        }
+        return true;
+    }
+
+    std::size_t CountNodes(const infofile::Node& node)
+    {
+        std::size_t count = 1;
+        for (const auto& c : node.children)
+        {
+            count += CountNodes(*c);
+        }
+        return count;
+    }
+
+    void CollectStrings(const infofile::Node& node, std::vector<std::string>* strings)
+    {
+        strings->emplace_back(node.name);
+        strings->emplace_back(node.value);
+        for (const auto& c : node.children)
+        {
+            CollectStrings(*c, strings);
+        }
+    }
+
+    /** Everything the benchmarks of a single shape need, prepared before timing.
+    */
+    struct Corpus
+    {
+        std::string name;
+        std::string source;
+        std::shared_ptr<infofile::Node> root;
+        std::size_t nodes = 0;
+        std::vector<std::string> strings;
+        std::size_t string_bytes = 0;
+        std::string filename;
+    };
+
+    std::shared_ptr<Corpus> MakeCorpus(const bench::CorpusEntry& entry, const std::filesystem::path& dir)
+    {
+        auto corpus = std::make_shared<Corpus>();
+        corpus->name = entry.name;
+        corpus->source = bench::Generate(entry.shape, entry.size, entry.seed);
+
+        std::vector<std::string> errors;
+        corpus->root = infofile::Parse(corpus->name, corpus->source, &errors);
+        for (const auto& e : errors)
+        {
+            std::cerr << e << "\n";
+        }
+        if (errors.empty() == false)
+        {
+            return nullptr;
+        }
+
+        corpus->nodes = CountNodes(*corpus->root);
+        CollectStrings(*corpus->root, &corpus->strings);
+        for (const auto& s : corpus->strings)
+        {
+            corpus->string_bytes += s.size();
+        }
+
+        corpus->filename = (dir / (corpus->name + ".info")).string();
+        std::ofstream f{corpus->filename, std::ios::binary};
+        f << corpus->source;
+        return corpus;
+    }
+
+    std::vector<bench::Benchmark> MakeBenchmarks(std::shared_ptr<Corpus> corpus)
+    {
+        std::vector<bench::Benchmark> benchmarks;
+
+        benchmarks.emplace_back(bench::Benchmark{"lexer/" + corpus->name, "tokens", [corpus]() {
+            std::vector<std::string> errors;
+            auto reader = infofile::MemoryReader{corpus->name, corpus->source.data(), corpus->source.size()};
+            auto lexer = infofile::Lexer{&reader, &errors};
+            std::size_t tokens = 0;
+            while (lexer.Read().type != infofile::TokenType::ENDOFFILE)
+            {
+                tokens += 1;
+            }
+            return bench::Work{corpus->source.size(), tokens};
+        }});
+
+        benchmarks.emplace_back(bench::Benchmark{"parser/" + corpus->name, "nodes", [corpus]() {
+            std::vector<std::string> errors;
+            const auto root = infofile::Parse(corpus->name, corpus->source, &errors);
+            return bench::Work{corpus->source.size(), root ? corpus->nodes : 0};
+        }});
+
+        benchmarks.emplace_back(bench::Benchmark{"print/" + corpus->name, "nodes", [corpus]() {
+            const auto printed = infofile::PrintToString(infofile::PrintOptions{}, corpus->root);
+            return bench::Work{printed.size(), corpus->nodes};
+        }});
+
+        benchmarks.emplace_back(bench::Benchmark{"printstring/" + corpus->name, "strings", [corpus]() {
+            std::string printed;
+            printed.reserve(corpus->string_bytes * 2);
+            for (const auto& s : corpus->strings)
+            {
+                infofile::PrintString(&printed, s);
+            }
+            return bench::Work{corpus->string_bytes, printed.empty() ? 0 : corpus->strings.size()};
+        }});
+
+        benchmarks.emplace_back(bench::Benchmark{"readfile/" + corpus->name, "nodes", [corpus]() {
+            std::vector<std::string> errors;
+            const auto root = infofile::ReadFile(corpus->filename, &errors);
+            return bench::Work{corpus->source.size(), root ? corpus->nodes : 0};
+        }});
+
+        return benchmarks;
+    }
+
+    std::vector<bench::CorpusEntry> CorpusEntries(const Arguments& args, std::vector<std::string>* errors)
+    {
+        if (args.corpus.empty() == false)
+        {
+            return bench::ReadCorpus(args.corpus, errors);
+        }
+
+        std::vector<bench::CorpusEntry> entries;
+        for (const auto shape : bench::AllShapes())
+        {
+            entries.emplace_back(bench::CorpusEntry{bench::ShapeName(shape), shape, args.size, args.seed});
+        }
+        return entries;
+    }
+
+    constexpr int NO_BASELINE_EXIT_CODE = 77;
+
+    /** Returns the exit code, 1 if anything got slower than the baseline.
+    */
+    int CompareToBaseline(const Arguments& args, const std::vector<bench::BenchmarkResult>& results)
+    {
+        const auto missing = std::filesystem::exists(args.baseline) == false;
+        if (args.update_baseline || missing)
+        {
+            if (bench::WriteResults(args.baseline, results) == false)
+            {
+                std::cerr << "Failed to write the baseline " << args.baseline << "\n";
+                return 1;
+            }
+            if (missing && args.update_baseline == false)
+            {
+                std::cout << "No baseline, stored the run in " << args.baseline << " and skipped the comparison\n";
+                return NO_BASELINE_EXIT_CODE;
+            }
+            std::cout << "Stored the baseline in " << args.baseline << "\n";
+            return 0;
+        }
+
+        std::vector<std::string> errors;
+        auto baseline = bench::ReadResults(args.baseline, &errors);
+        const auto filtered = [&args](const bench::BenchmarkResult& r) { return r.name.find(args.filter) == std::string::npos; };
+        baseline.erase(std::remove_if(baseline.begin(), baseline.end(), filtered), baseline.end());
+        for (const auto& e : errors)
+        {
+            std::cerr << e << "\n";
+        }
+        if (errors.empty() == false)
+        {
+            return 1;
+        }
+
+        std::cout << "\nCompared to " << args.baseline << "\n";
+        auto exit_code = 0;
+        for (const auto& c : bench::Compare(baseline, results, args.threshold))
+        {
+            std::cout << bench::FormatComparison(c) << "\n";
+            if (c.verdict == bench::Verdict::SLOWER)
+            {
+                exit_code = 1;
+            }
+        }
+        return exit_code;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Arguments args;
+    if (ParseArguments(argc, argv, &args) == false)
+    {
+        return 1;
+    }
+
+    std::vector<std::string> errors;
+    const auto entries = CorpusEntries(args, &errors);
+    for (const auto& e : errors)
+    {
+        std::cerr << e << "\n";
+    }
+    if (errors.empty() == false)
+    {
+        return 1;
+    }
+
+    const auto dir = std::filesystem::temp_directory_path() / "infofile_bench";
+    std::filesystem::create_directories(dir);
+
+    std::vector<bench::Benchmark> benchmarks;
+    for (const auto& entry : entries)
+    {
+        const auto corpus = MakeCorpus(entry, dir);
+        if (corpus == nullptr)
+        {
+            std::cerr << "The generated " << entry.name << " source has errors\n";
+            return 1;
+        }
+        for (auto& b : MakeBenchmarks(corpus))
+        {
+            if (b.name.find(args.filter) != std::string::npos)
+            {
+                benchmarks.emplace_back(std::move(b));
+            }
+        }
+    }
+
+    std::cout << bench::FormatHeader() << "\n";
+    std::vector<bench::BenchmarkResult> results;
+    for (const auto& b : benchmarks)
+    {
+        results.emplace_back(bench::RunBenchmark(b, args.options));
+        std::cout << bench::FormatResult(results.back()) << std::endl;
+    }
+    std::filesystem::remove_all(dir);
+
+    if (args.json.empty() == false && bench::WriteResults(args.json, results) == false)
+    {
+        std::cerr << "Failed to write " << args.json << "\n";
+        return 1;
+    }
+
+    if (args.baseline.empty() == false)
+    {
+        return CompareToBaseline(args, results);
+    }
+    return 0;
+}
@@ -0,0 +1,106 @@
+#include "benchmark.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "fmt/core.h"
+
+namespace bench
+{
+    namespace
+    {
+        using Clock = std::chrono::steady_clock;
+
+        double Seconds(Clock::duration duration)
+        {
+            return std::chrono::duration<double>(duration).count();
+        }
+
+        std::string FormatTime(double seconds)
+        {
+            if (seconds >= 1.0)
+            {
+                return fmt::format("{:.3f} s", seconds);
+            }
+            if (seconds >= 1e-3)
+            {
+                return fmt::format("{:.3f} ms", seconds * 1e3);
+            }
+            return fmt::format("{:.3f} us", seconds * 1e6);
+        }
+
+        std::string FormatCount(double count)
+        {
+            if (count >= 1e9)
+            {
+                return fmt::format("{:.2f}G", count / 1e9);
+            }
+            if (count >= 1e6)
+            {
+                return fmt::format("{:.2f}M", count / 1e6);
+            }
+            if (count >= 1e3)
+            {
+                return fmt::format("{:.2f}k", count / 1e3);
+            }
+            return fmt::format("{:.0f}", count);
+        }
+    }
+
+    double BenchmarkResult::BytesPerSecond() const
+    {
+        return median > 0 ? static_cast<double>(work.bytes) / median : 0;
+    }
+
+    double BenchmarkResult::ItemsPerSecond() const
+    {
+        return median > 0 ? static_cast<double>(work.items) / median : 0;
+    }
+
+    BenchmarkResult RunBenchmark(const Benchmark& benchmark, const BenchmarkOptions& options)
+    {
+        BenchmarkResult result;
+        result.name = benchmark.name;
+        result.unit = benchmark.unit;
+
+        // the first run warms the caches and tells how many runs fill the minimum time
+        const auto warmup_start = Clock::now();
+        result.work = benchmark.run();
+        const auto warmup = std::max(Seconds(Clock::now() - warmup_start), 1e-9);
+        const auto iterations = std::max<std::size_t>(1, static_cast<std::size_t>(options.min_seconds / warmup));
+
+        std::vector<double> times;
+        for (int repetition = 0; repetition < std::max(options.repetitions, 1); repetition += 1)
+        {
+            const auto start = Clock::now();
+            for (std::size_t i = 0; i < iterations; i += 1)
+            {
+                benchmark.run();
+            }
+            times.emplace_back(Seconds(Clock::now() - start) / static_cast<double>(iterations));
+        }
+
+        std::sort(times.begin(), times.end());
+        result.iterations = iterations;
+        result.median = times[times.size() / 2];
+        result.min = times.front();
+        result.max = times.back();
+        return result;
+    }
+
+    std::string FormatHeader()
+    {
+        return fmt::format("{:<32} {:>12} {:>10} {:>10} {:>16}", "Benchmark", "Time", "Iterations", "MB/s", "Items/s");
+    }
+
+    std::string FormatResult(const BenchmarkResult& result)
+    {
+        return fmt::format(
+            "{:<32} {:>12} {:>10} {:>10.1f} {:>16}",
+            result.name,
+            FormatTime(result.median),
+            result.iterations,
+            result.BytesPerSecond() / (1024.0 * 1024.0),
+            fmt::format("{} {}/s", FormatCount(result.ItemsPerSecond()), result.unit));
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace bench
+{
+    /** What a single run of a benchmark processed, used for the throughput.
+    */
+    struct Work
+    {
+        std::size_t bytes = 0;
+        std::size_t items = 0;
+    };
+
+    struct Benchmark
+    {
+        std::string name;
+
+        /** What the items are, such as tokens or nodes.
+        */
+        std::string unit;
+
+        std::function<Work()> run;
+    };
+
+    struct BenchmarkOptions
+    {
+        /** Each repetition runs the benchmark at least this long.
+        */
+        double min_seconds = 0.2;
+        int repetitions = 3;
+    };
+
+    struct BenchmarkResult
+    {
+        std::string name;
+        std::string unit;
+        std::size_t iterations = 0;
+
+        /** Seconds per run, the median and the spread of the repetitions.
+        */
+        double median = 0;
+        double min = 0;
+        double max = 0;
+
+        Work work;
+
+        double BytesPerSecond() const;
+        double ItemsPerSecond() const;
+    };
+
+    BenchmarkResult RunBenchmark(const Benchmark& benchmark, const BenchmarkOptions& options);
+
+    std::string FormatHeader();
+    std::string FormatResult(const BenchmarkResult& result);
+}
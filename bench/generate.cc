@@ -0,0 +1,246 @@
+#include "generate.h"
+
+#include <cassert>
+
+#include "fmt/core.h"
+
+namespace bench
+{
+    namespace
+    {
+        const char* const WORDS[] = {
+            "alpha", "bravo", "charlie", "delta", "echo", "foxtrot", "golf", "hotel",
+            "india", "juliet", "kilo", "lima", "mike", "november", "oscar", "papa"};
+        constexpr std::size_t WORD_COUNT = sizeof(WORDS) / sizeof(WORDS[0]);
+
+        std::string Word(Random* random)
+        {
+            return WORDS[random->Below(WORD_COUNT)];
+        }
+
+        std::string Key(Random* random, std::size_t index)
+        {
+            return fmt::format("{}_{}", Word(random), index);
+        }
+
+        std::string Sentence(Random* random, std::size_t words)
+        {
+            std::string ret;
+            for (std::size_t i = 0; i < words; i += 1)
+            {
+                if (i != 0)
+                {
+                    ret += ' ';
+                }
+                ret += Word(random);
+            }
+            return ret;
+        }
+
+        std::string Number(Random* random)
+        {
+            const auto value = random->Below(100000);
+            switch (random->Below(5))
+            {
+            case 0:
+                return fmt::format("-{}", value);
+            case 1:
+                return fmt::format("{}.{}", value, random->Below(1000));
+            case 2:
+                return fmt::format("0x{:x}", value + 1);
+            case 3:
+                return fmt::format("0b{:b}", random->Below(256) + 1);
+            default:
+                return fmt::format("{}", value);
+            }
+        }
+
+        void AppendWide(std::string* out, Random* random, std::size_t index)
+        {
+            switch (random->Below(3))
+            {
+            case 0:
+                *out += fmt::format("{} {};\n", Key(random, index), Word(random));
+                break;
+            case 1:
+                *out += fmt::format("{} \"{}\";\n", Key(random, index), Sentence(random, 1 + random->Below(6)));
+                break;
+            default:
+                *out += fmt::format("{} = {};\n", Key(random, index), Number(random));
+                break;
+            }
+        }
+
+        void AppendDeep(std::string* out, Random* random, std::size_t index)
+        {
+            const auto depth = 16 + random->Below(48);
+            for (std::size_t d = 0; d < depth; d += 1)
+            {
+                *out += std::string(d * 2, ' ');
+                *out += fmt::format("{} {} {{\n", Key(random, index), d);
+            }
+            *out += std::string(depth * 2, ' ');
+            *out += fmt::format("leaf \"{}\";\n", Sentence(random, 3));
+            for (std::size_t d = depth; d > 0; d -= 1)
+            {
+                *out += std::string((d - 1) * 2, ' ');
+                *out += "}\n";
+            }
+        }
+
+        void AppendLongString(std::string* out, Random* random, std::size_t index)
+        {
+            const auto words = 150 + random->Below(600);
+            std::string text;
+            for (std::size_t i = 0; i < words; i += 1)
+            {
+                text += Word(random);
+                switch (random->Below(20))
+                {
+                case 0:
+                    text += "\\n";
+                    break;
+                case 1:
+                    text += " \\\"quoted\\\" ";
+                    break;
+                default:
+                    text += ' ';
+                    break;
+                }
+            }
+            *out += fmt::format("{} \"{}\";\n", Key(random, index), text);
+        }
+
+        void AppendHeredoc(std::string* out, Random* random, std::size_t index)
+        {
+            *out += fmt::format("{} <<EOF\n", Key(random, index));
+            const auto lines = 5 + random->Below(40);
+            for (std::size_t i = 0; i < lines; i += 1)
+            {
+                *out += Sentence(random, 2 + random->Below(12));
+                *out += '\n';
+            }
+            *out += "EOF\n";
+        }
+
+        void AppendComments(std::string* out, Random* random, std::size_t index)
+        {
+            const auto lines = 2 + random->Below(4);
+            for (std::size_t i = 0; i < lines; i += 1)
+            {
+                *out += fmt::format("// {}\n", Sentence(random, 4 + random->Below(10)));
+            }
+            if (random->Below(2) == 0)
+            {
+                *out += fmt::format("/* {}\n   {} */\n", Sentence(random, 8), Sentence(random, 8));
+            }
+            *out += fmt::format("{} {}; // {}\n", Key(random, index), Word(random), Sentence(random, 3));
+        }
+
+        void AppendNumericArray(std::string* out, Random* random, std::size_t index)
+        {
+            *out += fmt::format("{} [", Key(random, index));
+            const auto count = 50 + random->Below(100);
+            for (std::size_t i = 0; i < count; i += 1)
+            {
+                if (i != 0)
+                {
+                    *out += ", ";
+                }
+                *out += Number(random);
+            }
+            *out += "]\n";
+        }
+    }
+
+    Random::Random(std::uint64_t seed)
+        : state(seed)
+    {
+    }
+
+    std::uint64_t Random::Next()
+    {
+        // splitmix64
+        state += 0x9e3779b97f4a7c15ULL;
+        auto z = state;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        return z ^ (z >> 31);
+    }
+
+    std::size_t Random::Below(std::size_t count)
+    {
+        assert(count > 0);
+        return Next() % count;
+    }
+
+    std::vector<Shape> AllShapes()
+    {
+        return {Shape::WIDE, Shape::DEEP, Shape::LONG_STRINGS, Shape::HEREDOCS, Shape::COMMENTS, Shape::NUMERIC_ARRAYS};
+    }
+
+    std::string ShapeName(Shape shape)
+    {
+        switch (shape)
+        {
+        case Shape::WIDE:
+            return "wide";
+        case Shape::DEEP:
+            return "deep";
+        case Shape::LONG_STRINGS:
+            return "long_strings";
+        case Shape::HEREDOCS:
+            return "heredocs";
+        case Shape::COMMENTS:
+            return "comments";
+        case Shape::NUMERIC_ARRAYS:
+            return "numeric_arrays";
+        }
+        return "unknown";
+    }
+
+    bool ShapeFromName(const std::string& name, Shape* shape)
+    {
+        for (const auto s : AllShapes())
+        {
+            if (ShapeName(s) == name)
+            {
+                *shape = s;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    std::string Generate(Shape shape, std::size_t bytes, std::uint64_t seed)
+    {
+        auto random = Random{seed};
+        std::string out;
+        out.reserve(bytes + 64 * 1024);
+        for (std::size_t index = 0; out.size() < bytes; index += 1)
+        {
+            switch (shape)
+            {
+            case Shape::WIDE:
+                AppendWide(&out, &random, index);
+                break;
+            case Shape::DEEP:
+                AppendDeep(&out, &random, index);
+                break;
+            case Shape::LONG_STRINGS:
+                AppendLongString(&out, &random, index);
+                break;
+            case Shape::HEREDOCS:
+                AppendHeredoc(&out, &random, index);
+                break;
+            case Shape::COMMENTS:
+                AppendComments(&out, &random, index);
+                break;
+            case Shape::NUMERIC_ARRAYS:
+                AppendNumericArray(&out, &random, index);
+                break;
+            }
+        }
+        return out;
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace bench
+{
+    /** A small random generator that gives the same numbers on every platform and standard library,
+    so a seed always generates the same corpus.
+    */
+    struct Random
+    {
+        explicit Random(std::uint64_t seed);
+
+        std::uint64_t Next();
+
+        /** A number from 0 up to but not including count.
+        */
+        std::size_t Below(std::size_t count);
+
+        std::uint64_t state;
+    };
+
+    enum class Shape
+    {
+        WIDE,  // many leafs in a single struct
+        DEEP,  // long chains of nested structs
+        LONG_STRINGS,  // quoted strings of a few KiB with escapes
+        HEREDOCS,  // multi line here docs
+        COMMENTS,  // mostly line and block comments
+        NUMERIC_ARRAYS  // arrays of integers, floats, hex and binary numbers
+    };
+
+    std::vector<Shape> AllShapes();
+    std::string ShapeName(Shape shape);
+
+    /** Returns false if the name isn't the name of a shape.
+    */
+    bool ShapeFromName(const std::string& name, Shape* shape);
+
+    /** Generate a source of about the given size, a little larger since the last node is completed.
+    */
+    std::string Generate(Shape shape, std::size_t bytes, std::uint64_t seed);
+}
@@ -0,0 +1,80 @@
+// Compares reading a directory of small files with ReadFile in a loop against ReadDirectory.
+// usage: bench_readdirectory [file count] [threads]
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "fmt/core.h"
+#include "infofile/bulkread.h"
+#include "infofile/infofile.h"
+
+namespace
+{
+    void GenerateFiles(const std::filesystem::path& dir, int count)
+    {
+        for (int i = 0; i < count; i += 1)
+        {
+            // spread the files over some subdirectories like a real config tree
+            const auto sub = dir / fmt::format("group_{}", i % 100);
+            std::filesystem::create_directories(sub);
+            std::ofstream f{sub / fmt::format("fragment_{}.info", i), std::ios::binary};
+            f << "fragment " << i << " {\n";
+            f << "    enabled true;\n";
+            f << "    name \"fragment number " << i << "\";\n";
+            f << "    weights [0.1 0.2 0.3 0.4]\n";
+            f << "}\n";
+        }
+    }
+
+    template <typename Function>
+    void Time(const std::string& name, int count, Function function)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        const auto files = function();
+        const auto end = std::chrono::steady_clock::now();
+
+        const auto ms = std::chrono::duration<double, std::milli>(end - start).count();
+        std::cout << fmt::format("{:24}: {:9.2f} ms, {:8.0f} files/s, {} files\n", name, ms, count / ms * 1000.0, files);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const int count = argc > 1 ? std::stoi(argv[1]) : 50000;
+    const std::size_t threads = argc > 2 ? std::stoul(argv[2]) : 0;
+
+    const auto dir = std::filesystem::temp_directory_path() / "infofile_bench_readdirectory";
+    std::filesystem::remove_all(dir);
+    GenerateFiles(dir, count);
+
+    std::cout << "reading " << count << " files, io_uring is " << (infofile::IsIoUringAvailable() ? "available" : "not available") << "\n";
+
+    Time("loop over ReadFile", count, [&]() {
+        std::size_t files = 0;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(dir))
+        {
+            if (entry.is_regular_file())
+            {
+                std::vector<std::string> errors;
+                infofile::ReadFile(entry.path().string(), &errors);
+                files += 1;
+            }
+        }
+        return files;
+    });
+
+    for (const auto use_io_uring : {false, true})
+    {
+        infofile::ReadDirectoryOptions options;
+        options.threads = threads;
+        options.use_io_uring = use_io_uring;
+        Time(use_io_uring ? "ReadDirectory io_uring" : "ReadDirectory thread pool", count, [&]() { return infofile::ReadDirectory(dir.string(), options).size(); });
+    }
+
+    std::filesystem::remove_all(dir);
+    return 0;
+}
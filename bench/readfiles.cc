@@ -0,0 +1,78 @@
+// Times ReadFiles on a synthetic set of small files with 1 to N threads.
+// usage: bench_readfiles [file count] [max threads]
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "fmt/core.h"
+#include "infofile/infofile.h"
+#include "infofile/threadpool.h"
+
+namespace
+{
+    std::vector<std::string> GenerateFiles(const std::filesystem::path& dir, int count)
+    {
+        std::filesystem::create_directories(dir);
+        std::vector<std::string> filenames;
+        for (int i = 0; i < count; i += 1)
+        {
+            const auto path = (dir / fmt::format("file_{}.info", i)).string();
+            std::ofstream f{path, std::ios::binary};
+            f << "// generated file " << i << "\n";
+            f << "id " << i << ";\n";
+            f << "name \"file number " << i << "\";\n";
+            f << "settings {\n";
+            for (int s = 0; s < 20; s += 1)
+            {
+                f << "    key_" << s << " = \"value " << s << "\";\n";
+            }
+            f << "    values [1 2 3 4 5 6 7 8 9 10]\n";
+            f << "}\n";
+            filenames.emplace_back(path);
+        }
+        return filenames;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const int count = argc > 1 ? std::stoi(argv[1]) : 4000;
+    const auto max_threads = argc > 2 ? std::stoul(argv[2]) : infofile::DefaultThreadCount();
+
+    const auto dir = std::filesystem::temp_directory_path() / "infofile_bench_readfiles";
+    const auto filenames = GenerateFiles(dir, count);
+
+    std::cout << "reading " << count << " files\n";
+    std::vector<std::size_t> thread_counts;
+    for (std::size_t threads = 1; threads < max_threads; threads *= 2)
+    {
+        thread_counts.emplace_back(threads);
+    }
+    thread_counts.emplace_back(max_threads);
+
+    for (const auto threads : thread_counts)
+    {
+        infofile::ReadFilesOptions options;
+        options.threads = threads;
+
+        const auto start = std::chrono::steady_clock::now();
+        const auto results = infofile::ReadFiles(filenames, options);
+        const auto end = std::chrono::steady_clock::now();
+
+        std::size_t errors = 0;
+        for (const auto& r : results)
+        {
+            errors += r.errors.size();
+        }
+
+        const auto ms = std::chrono::duration<double, std::milli>(end - start).count();
+        std::cout << fmt::format("{:3} threads: {:8.2f} ms, {:8.0f} files/s, {} errors\n", threads, ms, count / ms * 1000.0, errors);
+    }
+
+    std::filesystem::remove_all(dir);
+    return 0;
+}
@@ -0,0 +1,224 @@
+#include "regression.h"
+
+#include <algorithm>
+#include <fstream>
+
+#include "fmt/core.h"
+#include "infofile/infofile.h"
+
+namespace bench
+{
+    namespace
+    {
+        const infofile::Node* FindChild(const infofile::Node& node, const std::string& name)
+        {
+            for (const auto& c : node.children)
+            {
+                if (c->name == name)
+                {
+                    return c.get();
+                }
+            }
+            return nullptr;
+        }
+
+        std::string Value(const infofile::Node& node, const std::string& name)
+        {
+            const auto* child = FindChild(node, name);
+            return child == nullptr ? "" : child->value;
+        }
+
+        double ToDouble(const std::string& str, const std::string& filename, std::vector<std::string>* errors)
+        {
+            try
+            {
+                return std::stod(str);
+            }
+            catch (const std::exception&)
+            {
+                errors->emplace_back(fmt::format("{}: invalid number {}", filename, str));
+                return 0;
+            }
+        }
+
+        std::uint64_t ToUnsigned(const std::string& str, const std::string& filename, std::vector<std::string>* errors)
+        {
+            try
+            {
+                return std::stoull(str);
+            }
+            catch (const std::exception&)
+            {
+                errors->emplace_back(fmt::format("{}: invalid number {}", filename, str));
+                return 0;
+            }
+        }
+
+        std::string Quote(const std::string& str)
+        {
+            std::string ret = "\"";
+            for (const auto c : str)
+            {
+                if (c == '"' || c == '\\')
+                {
+                    ret += '\\';
+                }
+                ret += c;
+            }
+            ret += '"';
+            return ret;
+        }
+
+        /** The relative difference between the fastest and slowest repetition.
+        */
+        double Spread(const BenchmarkResult& result)
+        {
+            return result.median > 0 ? (result.max - result.min) / result.median : 0;
+        }
+    }
+
+    std::vector<CorpusEntry> ReadCorpus(const std::string& filename, std::vector<std::string>* errors)
+    {
+        std::vector<CorpusEntry> entries;
+        const auto root = infofile::ReadFile(filename, errors);
+        if (root == nullptr || errors->empty() == false)
+        {
+            return entries;
+        }
+
+        for (const auto& c : root->children)
+        {
+            CorpusEntry entry;
+            entry.name = c->name;
+            if (ShapeFromName(Value(*c, "shape"), &entry.shape) == false)
+            {
+                errors->emplace_back(fmt::format("{}: {} has a invalid shape {}", filename, c->name, Value(*c, "shape")));
+                continue;
+            }
+            entry.size = ToUnsigned(Value(*c, "size"), filename, errors);
+            entry.seed = ToUnsigned(Value(*c, "seed"), filename, errors);
+            entries.emplace_back(entry);
+        }
+        return entries;
+    }
+
+    bool WriteResults(const std::string& filename, const std::vector<BenchmarkResult>& results)
+    {
+        std::ofstream f{filename, std::ios::binary};
+        f << "{\n  \"benchmarks\": [\n";
+        for (std::size_t i = 0; i < results.size(); i += 1)
+        {
+            const auto& r = results[i];
+            f << fmt::format(
+                "    {{\"name\": {}, \"unit\": {}, \"iterations\": {}, \"median\": {:.9f}, \"min\": {:.9f}, \"max\": {:.9f}, \"bytes\": {}, \"items\": {}, \"mb_per_second\": {:.3f}, \"items_per_second\": {:.1f}}}{}\n",
+                Quote(r.name),
+                Quote(r.unit),
+                r.iterations,
+                r.median,
+                r.min,
+                r.max,
+                r.work.bytes,
+                r.work.items,
+                r.BytesPerSecond() / (1024.0 * 1024.0),
+                r.ItemsPerSecond(),
+                i + 1 < results.size() ? "," : "");
+        }
+        f << "  ]\n}\n";
+        return f.good();
+    }
+
+    std::vector<BenchmarkResult> ReadResults(const std::string& filename, std::vector<std::string>* errors)
+    {
+        std::vector<BenchmarkResult> results;
+        const auto root = infofile::ReadFile(filename, errors);
+        if (root == nullptr || errors->empty() == false)
+        {
+            return results;
+        }
+
+        const auto* benchmarks = FindChild(*root, "benchmarks");
+        if (benchmarks == nullptr)
+        {
+            errors->emplace_back(fmt::format("{}: missing benchmarks", filename));
+            return results;
+        }
+
+        for (const auto& c : benchmarks->children)
+        {
+            BenchmarkResult r;
+            r.name = Value(*c, "name");
+            r.unit = Value(*c, "unit");
+            r.iterations = ToUnsigned(Value(*c, "iterations"), filename, errors);
+            r.median = ToDouble(Value(*c, "median"), filename, errors);
+            r.min = ToDouble(Value(*c, "min"), filename, errors);
+            r.max = ToDouble(Value(*c, "max"), filename, errors);
+            r.work.bytes = ToUnsigned(Value(*c, "bytes"), filename, errors);
+            r.work.items = ToUnsigned(Value(*c, "items"), filename, errors);
+            results.emplace_back(r);
+        }
+        return results;
+    }
+
+    std::vector<Comparison> Compare(const std::vector<BenchmarkResult>& baseline, const std::vector<BenchmarkResult>& current, double threshold)
+    {
+        std::vector<Comparison> comparisons;
+        for (const auto& c : current)
+        {
+            Comparison comparison;
+            comparison.name = c.name;
+            comparison.current = c.min;
+
+            const auto found = std::find_if(baseline.begin(), baseline.end(), [&c](const BenchmarkResult& b) { return b.name == c.name; });
+            if (found == baseline.end())
+            {
+                comparison.verdict = Verdict::NEW;
+                comparisons.emplace_back(comparison);
+                continue;
+            }
+
+            comparison.baseline = found->min;
+            comparison.allowed = threshold + std::max(Spread(*found), Spread(c));
+            if (c.min > found->min * (1 + comparison.allowed))
+            {
+                comparison.verdict = Verdict::SLOWER;
+            }
+            else if (c.min * (1 + comparison.allowed) < found->min)
+            {
+                comparison.verdict = Verdict::FASTER;
+            }
+            comparisons.emplace_back(comparison);
+        }
+
+        for (const auto& b : baseline)
+        {
+            const auto found = std::find_if(current.begin(), current.end(), [&b](const BenchmarkResult& c) { return b.name == c.name; });
+            if (found == current.end())
+            {
+                Comparison comparison;
+                comparison.name = b.name;
+                comparison.baseline = b.min;
+                comparison.verdict = Verdict::MISSING;
+                comparisons.emplace_back(comparison);
+            }
+        }
+
+        return comparisons;
+    }
+
+    std::string FormatComparison(const Comparison& comparison)
+    {
+        switch (comparison.verdict)
+        {
+        case Verdict::NEW:
+            return fmt::format("{:<32} new", comparison.name);
+        case Verdict::MISSING:
+            return fmt::format("{:<32} missing from this run", comparison.name);
+        default:
+            break;
+        }
+
+        const auto change = comparison.baseline > 0 ? comparison.current / comparison.baseline - 1 : 0;
+        const auto verdict = comparison.verdict == Verdict::SLOWER ? "SLOWER" : comparison.verdict == Verdict::FASTER ? "faster" : "same";
+        return fmt::format("{:<32} {:>+8.1f}% (allowed {:.1f}%) {}", comparison.name, change * 100, comparison.allowed * 100, verdict);
+    }
+}
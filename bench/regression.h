@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "generate.h"
+
+namespace bench
+{
+    /** A generated source that is benchmarked, the same entry always generates the same source.
+    */
+    struct CorpusEntry
+    {
+        std::string name;
+        Shape shape = Shape::WIDE;
+        std::size_t size = 0;
+        std::uint64_t seed = 0;
+    };
+
+    /** Read a corpus file, a info file with one node per entry:
+    name { shape wide; size 1048576; seed 1 }
+    */
+    std::vector<CorpusEntry> ReadCorpus(const std::string& filename, std::vector<std::string>* errors);
+
+    /** Results are stored as JSON, returns false if the file couldn't be written.
+    */
+    bool WriteResults(const std::string& filename, const std::vector<BenchmarkResult>& results);
+
+    /** Read results written by WriteResults, the JSON is read with the info file parser.
+    */
+    std::vector<BenchmarkResult> ReadResults(const std::string& filename, std::vector<std::string>* errors);
+
+    enum class Verdict
+    {
+        SAME,
+        FASTER,
+        SLOWER,
+        NEW,  // not in the baseline
+        MISSING  // only in the baseline
+    };
+
+    struct Comparison
+    {
+        std::string name;
+
+        /** Seconds of the fastest repetition.
+        */
+        double baseline = 0;
+        double current = 0;
+
+        /** How much the time of the fastest repetition may change before it counts, the threshold plus the noise of the runs.
+        */
+        double allowed = 0;
+        Verdict verdict = Verdict::SAME;
+    };
+
+    /** Compare the fastest repetitions, since noise only ever adds time, a change only counts if it's larger
+    than threshold plus the relative spread between the fastest and slowest repetition of either run.
+    */
+    std::vector<Comparison> Compare(const std::vector<BenchmarkResult>& baseline, const std::vector<BenchmarkResult>& current, double threshold);
+
+    std::string FormatComparison(const Comparison& comparison);
+}
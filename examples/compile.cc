@@ -0,0 +1,36 @@
+#include <iostream>
+#include <string>
+
+#include "infofile/binary.h"
+#include "infofile/infofile.h"
+#include "infofile/mapped.h"
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: compile input.info output.infob [--mapped]\n";
+        return 1;
+    }
+
+    std::vector<std::string> errors;
+    std::shared_ptr<infofile::Node> val = infofile::ReadFile(argv[1], &errors);
+    for (const auto& e : errors)
+    {
+        std::cerr << e << "\n";
+    }
+    if (errors.empty() == false || val == nullptr)
+    {
+        return 1;
+    }
+
+    const bool mapped = argc > 3 && std::string(argv[3]) == "--mapped";
+    const bool written = mapped ? infofile::WriteMappedFile(argv[2], val) : infofile::WriteBinaryFile(argv[2], val);
+    if (written == false)
+    {
+        std::cerr << "Failed to write " << argv[2] << "\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -1,4 +1,5 @@
 #define CATCH_CONFIG_MAIN
+// newer glibc no longer has a constant MINSIGSTKSZ which the bundled catch needs for its signal handler
+#define CATCH_CONFIG_NO_POSIX_SIGNALS
 #include "catch.hpp"
 
-
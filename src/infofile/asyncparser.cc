@@ -0,0 +1,46 @@
+#include "infofile/asyncparser.h"
+
+namespace infofile
+{
+    AsyncParser::AsyncParser(const std::string& filename, std::function<void(FileResult)> on_done)
+        : AsyncParser(filename, std::move(on_done), DEFAULT_MAX_BLOCKS)
+    {
+    }
+
+    AsyncParser::AsyncParser(const std::string& filename, std::function<void(FileResult)> on_done, std::size_t max_blocks)
+        : blocks(max_blocks)
+        , reader(filename, &blocks)
+    {
+        thread = std::thread([this, on_done = std::move(on_done)]() {
+            FileResult result;
+            result.filename = reader.filename;
+            result.root = ParseFromFile(&reader, &result.errors);
+            on_done(std::move(result));
+        });
+    }
+
+    AsyncParser::~AsyncParser()
+    {
+        Finish();
+        thread.join();
+    }
+
+    FeedResult AsyncParser::Feed(const std::string& data)
+    {
+        switch (blocks.TryPush({data.begin(), data.end()}))
+        {
+        case PushResult::PUSHED:
+            return FeedResult::ACCEPTED;
+        case PushResult::FULL:
+            return FeedResult::FULL;
+        case PushResult::REFUSED:
+            return FeedResult::FINISHED;
+        }
+        return FeedResult::FINISHED;
+    }
+
+    void AsyncParser::Finish()
+    {
+        blocks.Close();
+    }
+}
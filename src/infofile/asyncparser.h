@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <thread>
+
+#include "infofile/infofile.h"
+#include "infofile/prefetch.h"
+
+namespace infofile
+{
+    enum class FeedResult
+    {
+        ACCEPTED,
+        FULL,  // the data was not taken, feed it again once the parser has caught up
+        FINISHED  // the input was already finished, the data is ignored
+    };
+
+    /** Parses input that arrives in pieces, for example from a socket on an event loop.
+    Feed and Finish never block the caller, the regular lexer and parser run on a separate thread
+    that waits when the input runs dry and continues when more is fed.
+    At most max_blocks fed pieces wait for the parser, after that Feed reports FULL so the loop can back off
+    instead of buffering an unbounded amount of input.
+    */
+    struct AsyncParser
+    {
+        static constexpr std::size_t DEFAULT_MAX_BLOCKS = 16;
+
+        /** on_done is called on the parsing thread, not on the thread that feeds the input,
+        so an event loop should post the result back to itself.
+        */
+        AsyncParser(const std::string& filename, std::function<void(FileResult)> on_done);
+        AsyncParser(const std::string& filename, std::function<void(FileResult)> on_done, std::size_t max_blocks);
+
+        /** Ends the input if it hasn't been finished and waits for the parsing to complete.
+        */
+        ~AsyncParser();
+
+        AsyncParser(const AsyncParser&) = delete;
+        void operator=(const AsyncParser&) = delete;
+
+        FeedResult Feed(const std::string& data);
+
+        /** There is no more input.
+        */
+        void Finish();
+
+        BlockQueue blocks;
+        QueueReader reader;
+        std::thread thread;
+    };
+}
@@ -0,0 +1,111 @@
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+#include "catch.hpp"
+#include "catchy/stringeq.h"
+#include "infofile/asyncparser.h"
+
+using namespace infofile;
+
+namespace
+{
+    /** A single threaded event loop like the ones the async parser is meant for.
+    */
+    struct EventLoop
+    {
+        void Post(std::function<void()> task)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                tasks.emplace_back(std::move(task));
+            }
+            changed.notify_all();
+        }
+
+        void RunUntil(const bool& done)
+        {
+            while (done == false)
+            {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    changed.wait(lock, [this]() { return tasks.empty() == false; });
+                    task = std::move(tasks.front());
+                    tasks.pop_front();
+                }
+                task();
+            }
+        }
+
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::deque<std::function<void()>> tasks;
+    };
+}
+
+TEST_CASE("async parser on an event loop", "[asyncparser]")
+{
+    const std::string src = "key1 value1;\nkey2 \"a longer value\" { a b; c [1 2 3] }\nkey3 <<EOF\nheredoc\nEOF\n";
+    std::vector<std::string> expected_errors;
+    const auto expected = Parse("inline", src, &expected_errors);
+
+    EventLoop loop;
+    bool done = false;
+    FileResult result;
+    AsyncParser parser{"inline", [&loop, &done, &result](FileResult r) {
+                           // hand the result back to the loop thread
+                           loop.Post([&done, &result, r = std::move(r)]() mutable {
+                               result = std::move(r);
+                               done = true;
+                           });
+                       },
+        1};
+
+    // the input arrives in small pieces, one per loop iteration
+    std::function<void(std::size_t)> receive = [&](std::size_t offset) {
+        if (offset >= src.size())
+        {
+            parser.Finish();
+            return;
+        }
+        // a full parser is fed the same piece again on a later iteration
+        const auto next = parser.Feed(src.substr(offset, 5)) == FeedResult::FULL ? offset : offset + 5;
+        loop.Post([&receive, next]() { receive(next); });
+    };
+    loop.Post([&receive]() { receive(0); });
+    loop.RunUntil(done);
+
+    CHECK(catchy::StringEq(result.filename, "inline"));
+    CHECK(catchy::StringEq(result.errors, expected_errors));
+    REQUIRE(result.root != nullptr);
+    CHECK(catchy::StringEq(PrintToString(PrintOptions{}, result.root), PrintToString(PrintOptions{}, expected)));
+}
+
+TEST_CASE("async parser finishes on destruction", "[asyncparser]")
+{
+    FileResult result;
+    {
+        AsyncParser parser{"inline", [&result](FileResult r) { result = std::move(r); }};
+        CHECK(parser.Feed("key value; another") == FeedResult::ACCEPTED);
+    }
+
+    REQUIRE(result.root != nullptr);
+    REQUIRE(2 == result.root->children.size());
+    CHECK("another" == result.root->children[1]->name);
+}
+
+TEST_CASE("async parser ignores input after finish", "[asyncparser]")
+{
+    FileResult result;
+    {
+        AsyncParser parser{"inline", [&result](FileResult r) { result = std::move(r); }};
+        CHECK(parser.Feed("key value") == FeedResult::ACCEPTED);
+        parser.Finish();
+        CHECK(parser.Feed("; another") == FeedResult::FINISHED);
+    }
+
+    REQUIRE(result.root != nullptr);
+    CHECK(1 == result.root->children.size());
+}
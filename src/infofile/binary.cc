@@ -0,0 +1,250 @@
+#include "infofile/binary.h"
+
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <unordered_map>
+
+#include "fmt/core.h"
+
+namespace infofile
+{
+    namespace
+    {
+        constexpr char MAGIC[] = {'I', 'N', 'F', 'B'};
+        constexpr std::size_t VERSION = 1;
+
+        struct Writer
+        {
+            std::size_t Intern(const std::string& str)
+            {
+                auto found = string_index.find(str);
+                if (found != string_index.end())
+                {
+                    return found->second;
+                }
+                const auto index = strings.size();
+                const auto inserted = string_index.emplace(str, index);
+                strings.emplace_back(&inserted.first->first);
+                return index;
+            }
+
+            void AddNode(const Node& node)
+            {
+                node_count += 1;
+                WriteVarint(&nodes, Intern(node.name));
+                WriteVarint(&nodes, Intern(node.value));
+                WriteVarint(&nodes, node.children.size());
+                for (const auto& child : node.children)
+                {
+                    AddNode(*child);
+                }
+            }
+
+            std::unordered_map<std::string, std::size_t> string_index;
+            std::vector<const std::string*> strings;
+            std::string nodes;
+            std::size_t node_count = 0;
+        };
+    }
+
+    void WriteVarint(std::string* out, std::size_t value)
+    {
+        while (value >= 0x80)
+        {
+            out->push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        out->push_back(static_cast<char>(value));
+    }
+
+    void WriteVarintString(std::string* out, const std::string& str)
+    {
+        WriteVarint(out, str.size());
+        out->append(str);
+    }
+
+    bool BinaryReader::ReadVarint(std::size_t* value)
+    {
+        constexpr int digits = std::numeric_limits<std::size_t>::digits;
+        *value = 0;
+        for (int shift = 0; shift < digits; shift += 7)
+        {
+            if (position >= size)
+            {
+                return false;
+            }
+            const auto byte = static_cast<unsigned char>(data[position]);
+            position += 1;
+            const auto bits = static_cast<std::size_t>(byte & 0x7F);
+            // the last byte can only hold the bits that are left, more would be silently dropped
+            if (shift > digits - 7 && (bits >> (digits - shift)) != 0)
+            {
+                return false;
+            }
+            *value |= bits << shift;
+            if ((byte & 0x80) == 0)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool BinaryReader::ReadString(std::string* str)
+    {
+        std::size_t length = 0;
+        if (ReadVarint(&length) == false || length > size - position)
+        {
+            return false;
+        }
+        str->assign(data + position, length);
+        position += length;
+        return true;
+    }
+
+    std::string WriteBinary(std::shared_ptr<Node> node)
+    {
+        Writer writer;
+        writer.AddNode(*node);
+
+        std::string out;
+        out.append(MAGIC, sizeof(MAGIC));
+        WriteVarint(&out, VERSION);
+        WriteVarint(&out, writer.strings.size());
+        WriteVarint(&out, writer.node_count);
+        for (const auto* str : writer.strings)
+        {
+            WriteVarintString(&out, *str);
+        }
+        out.append(writer.nodes);
+        return out;
+    }
+
+    std::shared_ptr<Node> ReadBinary(const std::string& filename, const std::string& data, std::vector<std::string>* errors)
+    {
+        auto error = [&](const std::string& message) -> std::shared_ptr<Node> {
+            errors->emplace_back(fmt::format("{}: {}", filename, message));
+            return nullptr;
+        };
+
+        if (data.size() < sizeof(MAGIC) || std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0)
+        {
+            return error("Not a binary info file");
+        }
+
+        auto reader = BinaryReader{data.data(), data.size(), sizeof(MAGIC)};
+        std::size_t version = 0;
+        std::size_t string_count = 0;
+        std::size_t node_count = 0;
+        if (!reader.ReadVarint(&version) || !reader.ReadVarint(&string_count) || !reader.ReadVarint(&node_count))
+        {
+            return error("Binary header is truncated");
+        }
+        if (version != VERSION)
+        {
+            return error(fmt::format("Unsupported binary version {}", version));
+        }
+        // every string needs at least one byte and every node at least three, don't let a bad count allocate everything
+        if (string_count > data.size() || node_count == 0 || node_count > data.size() / 3)
+        {
+            return error("Invalid number of strings or nodes");
+        }
+
+        std::vector<std::string> strings;
+        strings.reserve(string_count);
+        for (std::size_t i = 0; i < string_count; i += 1)
+        {
+            std::string str;
+            if (reader.ReadString(&str) == false)
+            {
+                return error("String table is truncated");
+            }
+            strings.emplace_back(std::move(str));
+        }
+
+        auto read_node = [&](std::size_t* child_count) -> std::shared_ptr<Node> {
+            std::size_t name = 0;
+            std::size_t value = 0;
+            if (!reader.ReadVarint(&name) || !reader.ReadVarint(&value) || !reader.ReadVarint(child_count))
+            {
+                return nullptr;
+            }
+            if (name >= strings.size() || value >= strings.size() || *child_count > node_count)
+            {
+                return nullptr;
+            }
+            return std::make_shared<Node>(strings[name], strings[value]);
+        };
+
+        struct Open
+        {
+            Node* node;
+            std::size_t remaining;
+        };
+
+        std::size_t root_children = 0;
+        auto root = read_node(&root_children);
+        if (root == nullptr)
+        {
+            return error("Invalid node");
+        }
+        std::size_t read_nodes = 1;
+
+        // nodes are depth first, read them without recursion so a deep tree can't overflow the stack
+        std::vector<Open> stack;
+        stack.emplace_back(Open{root.get(), root_children});
+        while (stack.empty() == false)
+        {
+            auto& top = stack.back();
+            if (top.remaining == 0)
+            {
+                stack.pop_back();
+                continue;
+            }
+            top.remaining -= 1;
+
+            std::size_t child_count = 0;
+            auto child = read_node(&child_count);
+            read_nodes += 1;
+            if (child == nullptr || read_nodes > node_count)
+            {
+                return error("Invalid node");
+            }
+            auto* parent = top.node;
+            if (parent->children.empty())
+            {
+                parent->children.reserve(top.remaining + 1);
+            }
+            parent->children.emplace_back(child);
+            if (child_count > 0)
+            {
+                stack.emplace_back(Open{child.get(), child_count});
+            }
+        }
+
+        if (read_nodes != node_count || reader.position != reader.size)
+        {
+            return error("Node count doesn't match the header");
+        }
+
+        return root;
+    }
+
+    bool WriteBinaryFile(const std::string& filename, std::shared_ptr<Node> node)
+    {
+        std::ofstream stream(filename, std::ios::binary);
+        const auto data = WriteBinary(node);
+        stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+        return stream.good();
+    }
+
+    std::shared_ptr<Node> ReadBinaryFile(const std::string& filename, std::vector<std::string>* errors)
+    {
+        std::ifstream stream(filename, std::ios::binary);
+        std::ostringstream data;
+        data << stream.rdbuf();
+        return ReadBinary(filename, data.str(), errors);
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "infofile/node.h"
+
+namespace infofile
+{
+    /** Serialize a tree to the compact binary format.
+    The format is a header, a table of all unique strings and then all nodes in depth first order,
+    every node is the index of the name and value in the string table and the number of children.
+    All numbers are stored as varints.
+    */
+    std::string WriteBinary(std::shared_ptr<Node> node);
+
+    /** Load a tree written by WriteBinary, returns null and adds a error if the data is malformed.
+    */
+    std::shared_ptr<Node> ReadBinary(const std::string& filename, const std::string& data, std::vector<std::string>* errors);
+
+    void WriteVarint(std::string* out, std::size_t value);
+    void WriteVarintString(std::string* out, const std::string& str);
+
+    /** Reads varints and strings written with the functions above.
+    */
+    struct BinaryReader
+    {
+        bool ReadVarint(std::size_t* value);
+        bool ReadString(std::string* str);
+
+        const char* data;
+        std::size_t size;
+        std::size_t position;
+    };
+
+    bool WriteBinaryFile(const std::string& filename, std::shared_ptr<Node> node);
+    std::shared_ptr<Node> ReadBinaryFile(const std::string& filename, std::vector<std::string>* errors);
+}
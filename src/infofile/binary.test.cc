@@ -0,0 +1,77 @@
+#include "catch.hpp"
+#include "catchy/stringeq.h"
+#include "infofile/binary.h"
+#include "infofile/infofile.h"
+
+using namespace infofile;
+
+namespace
+{
+    void CheckRoundTrip(const std::string& src)
+    {
+        std::vector<std::string> errors;
+        const auto parsed = Parse("inline", src, &errors);
+        REQUIRE(parsed != nullptr);
+
+        const auto binary = WriteBinary(parsed);
+        const auto loaded = ReadBinary("binary", binary, &errors);
+        REQUIRE(loaded != nullptr);
+        CHECK(catchy::StringEq(PrintToString(PrintOptions{}, loaded), PrintToString(PrintOptions{}, parsed)));
+    }
+}
+
+TEST_CASE("binary round trip", "[binary]")
+{
+    CheckRoundTrip("");
+    CheckRoundTrip("key value");
+    CheckRoundTrip("[1 2 3 4 5]");
+    CheckRoundTrip("a { b c { d e } f [g h] } i j { k l }");
+    CheckRoundTrip("\"hello\\0world\" \"a\\nb\" zero \"\"");
+    CheckRoundTrip("a { b { c { d { e { f { g h } } } } } }");
+}
+
+TEST_CASE("binary interns strings", "[binary]")
+{
+    std::vector<std::string> errors;
+    const auto shared = WriteBinary(Parse("inline", "a very_long_value_here; b very_long_value_here; c very_long_value_here", &errors));
+    const auto distinct = WriteBinary(Parse("inline", "a very_long_value_here1; b very_long_value_here2; c very_long_value_here3", &errors));
+
+    // the shared value is only stored once
+    CHECK(shared.size() + 2 * std::string("very_long_value_here").size() < distinct.size());
+}
+
+TEST_CASE("binary rejects bad data", "[binary]")
+{
+    std::vector<std::string> errors;
+    const auto parsed = Parse("inline", "a { b c } d e", &errors);
+    const auto binary = WriteBinary(parsed);
+
+    SECTION("not binary")
+    {
+        CHECK(ReadBinary("bad", "key value", &errors) == nullptr);
+        CHECK(catchy::StringEq(errors, {"bad: Not a binary info file"}));
+    }
+
+    SECTION("truncated")
+    {
+        for (std::size_t size = 0; size < binary.size(); size += 1)
+        {
+            CHECK(ReadBinary("bad", binary.substr(0, size), &errors) == nullptr);
+        }
+        CHECK(binary.size() == errors.size());
+    }
+
+    SECTION("varint overflow")
+    {
+        // the version 1 with a bit past the size of a std::size_t in the last byte
+        const auto version = "\x81" + std::string(8, '\x80') + "\x02";
+        CHECK(ReadBinary("bad", binary.substr(0, 4) + version + binary.substr(5), &errors) == nullptr);
+        CHECK(catchy::StringEq(errors, {"bad: Binary header is truncated"}));
+    }
+
+    SECTION("trailing data")
+    {
+        CHECK(ReadBinary("bad", binary + "x", &errors) == nullptr);
+        CHECK(1 == errors.size());
+    }
+}
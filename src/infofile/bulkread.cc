@@ -0,0 +1,461 @@
+#include "infofile/bulkread.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "infofile/threadpool.h"
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+// IORING_OP_OPENAT and IORING_OP_READ came with the 5.6 headers
+#if defined(IORING_FEAT_CUR_PERSONALITY)
+#define INFOFILE_IO_URING 1
+#endif
+#endif
+
+namespace infofile
+{
+    namespace
+    {
+        std::string LoadFileContent(const std::string& filename)
+        {
+            std::ifstream stream(filename, std::ios::binary);
+            std::ostringstream data;
+            data << stream.rdbuf();
+            return data.str();
+        }
+
+        void LoadFilesOnPool(const std::vector<std::string>& filenames, ThreadPool* pool, const OnFileLoaded& on_loaded)
+        {
+            for (std::size_t i = 0; i < filenames.size(); i += 1)
+            {
+                pool->Submit([&filenames, &on_loaded, i]() { on_loaded(i, LoadFileContent(filenames[i])); });
+            }
+            pool->Wait();
+        }
+
+#if defined(INFOFILE_IO_URING)
+        /** A minimal io_uring using the raw syscalls.
+        */
+        struct Uring
+        {
+            Uring()
+                : fd(-1)
+                , sq_ring(MAP_FAILED)
+                , sq_ring_size(0)
+                , cq_ring(MAP_FAILED)
+                , cq_ring_size(0)
+                , sqe_memory(MAP_FAILED)
+                , sqe_memory_size(0)
+                , sq_head(nullptr)
+                , sq_tail(nullptr)
+                , sq_mask(nullptr)
+                , sq_array(nullptr)
+                , sqes(nullptr)
+                , cq_head(nullptr)
+                , cq_tail(nullptr)
+                , cq_mask(nullptr)
+                , cqes(nullptr)
+                , queued(0)
+            {
+            }
+
+            ~Uring()
+            {
+                if (sqe_memory != MAP_FAILED)
+                {
+                    munmap(sqe_memory, sqe_memory_size);
+                }
+                if (cq_ring != MAP_FAILED && cq_ring != sq_ring)
+                {
+                    munmap(cq_ring, cq_ring_size);
+                }
+                if (sq_ring != MAP_FAILED)
+                {
+                    munmap(sq_ring, sq_ring_size);
+                }
+                if (fd >= 0)
+                {
+                    close(fd);
+                }
+            }
+
+            Uring(const Uring&) = delete;
+            void operator=(const Uring&) = delete;
+
+            template <typename T>
+            static T* At(void* base, __u32 offset)
+            {
+                return static_cast<T*>(static_cast<void*>(static_cast<char*>(base) + offset));
+            }
+
+            bool Setup(unsigned entries)
+            {
+                io_uring_params params;
+                std::memset(&params, 0, sizeof(params));
+                fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+                if (fd < 0)
+                {
+                    return false;
+                }
+
+                sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(__u32);
+                cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+                const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+                if (single_mmap)
+                {
+                    sq_ring_size = std::max(sq_ring_size, cq_ring_size);
+                    cq_ring_size = sq_ring_size;
+                }
+
+                sq_ring = mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+                if (sq_ring == MAP_FAILED)
+                {
+                    return false;
+                }
+                cq_ring = single_mmap ? sq_ring : mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+                if (cq_ring == MAP_FAILED)
+                {
+                    return false;
+                }
+                sqe_memory_size = params.sq_entries * sizeof(io_uring_sqe);
+                sqe_memory = mmap(nullptr, sqe_memory_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+                if (sqe_memory == MAP_FAILED)
+                {
+                    return false;
+                }
+
+                sq_head = At<__u32>(sq_ring, params.sq_off.head);
+                sq_tail = At<__u32>(sq_ring, params.sq_off.tail);
+                sq_mask = At<__u32>(sq_ring, params.sq_off.ring_mask);
+                sq_array = At<__u32>(sq_ring, params.sq_off.array);
+                sqes = static_cast<io_uring_sqe*>(sqe_memory);
+                cq_head = At<__u32>(cq_ring, params.cq_off.head);
+                cq_tail = At<__u32>(cq_ring, params.cq_off.tail);
+                cq_mask = At<__u32>(cq_ring, params.cq_off.ring_mask);
+                cqes = At<io_uring_cqe>(cq_ring, params.cq_off.cqes);
+                return true;
+            }
+
+            /** The caller makes sure there is never more entries queued than the ring can hold.
+            */
+            io_uring_sqe* Queue(__u8 opcode, int file, __u64 user_data)
+            {
+                const auto tail = *sq_tail;
+                const auto index = tail & *sq_mask;
+                auto* sqe = &sqes[index];
+                std::memset(sqe, 0, sizeof(io_uring_sqe));
+                sqe->opcode = opcode;
+                sqe->fd = file;
+                sqe->user_data = user_data;
+                sq_array[index] = index;
+                __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+                queued += 1;
+                return sqe;
+            }
+
+            /** Submit the queued entries and wait for at least one completion.
+            */
+            bool SubmitAndWait()
+            {
+                for (;;)
+                {
+                    const auto r = syscall(__NR_io_uring_enter, fd, queued, 1u, IORING_ENTER_GETEVENTS, nullptr, std::size_t{0});
+                    if (r >= 0)
+                    {
+                        queued -= static_cast<unsigned>(r);
+                        return true;
+                    }
+                    if (errno != EINTR)
+                    {
+                        return false;
+                    }
+                }
+            }
+
+            /** Wait for at least one completion without submitting anything.
+            */
+            bool Wait()
+            {
+                for (;;)
+                {
+                    const auto r = syscall(__NR_io_uring_enter, fd, 0u, 1u, IORING_ENTER_GETEVENTS, nullptr, std::size_t{0});
+                    if (r >= 0)
+                    {
+                        return true;
+                    }
+                    if (errno != EINTR)
+                    {
+                        return false;
+                    }
+                }
+            }
+
+            /** The number of queued entries the kernel hasn't taken yet, they will never complete unless submitted.
+            */
+            std::size_t Unsubmitted() const
+            {
+                return *sq_tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+            }
+
+            template <typename Callback>
+            void Reap(Callback callback)
+            {
+                auto head = *cq_head;
+                const auto tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+                while (head != tail)
+                {
+                    const auto cqe = cqes[head & *cq_mask];
+                    head += 1;
+                    __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+                    callback(cqe.user_data, cqe.res);
+                }
+            }
+
+            int fd;
+            void* sq_ring;
+            std::size_t sq_ring_size;
+            void* cq_ring;
+            std::size_t cq_ring_size;
+            void* sqe_memory;
+            std::size_t sqe_memory_size;
+
+            __u32* sq_head;
+            __u32* sq_tail;
+            __u32* sq_mask;
+            __u32* sq_array;
+            io_uring_sqe* sqes;
+            __u32* cq_head;
+            __u32* cq_tail;
+            __u32* cq_mask;
+            io_uring_cqe* cqes;
+
+            unsigned queued;
+        };
+
+        enum class Stage
+        {
+            FREE,
+            OPEN,
+            READ,
+            CLOSE
+        };
+
+        struct Slot
+        {
+            Stage stage = Stage::FREE;
+            std::size_t index = 0;
+            int fd = -1;
+            std::string data;
+            std::size_t read = 0;
+        };
+
+        bool LoadFilesWithUring(const std::vector<std::string>& filenames, unsigned queue_depth, ThreadPool* pool, const OnFileLoaded& on_loaded)
+        {
+            Uring ring;
+            if (ring.Setup(queue_depth) == false)
+            {
+                return false;
+            }
+
+            // every slot has at most one operation in flight so the submission queue never overflows
+            std::vector<Slot> slots(queue_depth);
+            std::size_t next_file = 0;
+            std::size_t in_flight = 0;
+
+            auto deliver = [&](std::size_t index, std::string data) {
+                pool->Submit([&on_loaded, index, d = std::move(data)]() mutable { on_loaded(index, std::move(d)); });
+            };
+            auto deliver_fallback = [&](std::size_t index) {
+                pool->Submit([&filenames, &on_loaded, index]() { on_loaded(index, LoadFileContent(filenames[index])); });
+            };
+
+            auto queue_read = [&](std::size_t slot_index) {
+                auto& slot = slots[slot_index];
+                slot.stage = Stage::READ;
+                auto* sqe = ring.Queue(IORING_OP_READ, slot.fd, slot_index);
+                sqe->addr = reinterpret_cast<__u64>(slot.data.data() + slot.read);
+                sqe->len = static_cast<__u32>(std::min<std::size_t>(slot.data.size() - slot.read, 1u << 30));
+                sqe->off = slot.read;
+            };
+            auto queue_close = [&](std::size_t slot_index) {
+                auto& slot = slots[slot_index];
+                slot.stage = Stage::CLOSE;
+                ring.Queue(IORING_OP_CLOSE, slot.fd, slot_index);
+            };
+
+            while (next_file < filenames.size() || in_flight > 0)
+            {
+                for (std::size_t slot_index = 0; slot_index < slots.size() && next_file < filenames.size(); slot_index += 1)
+                {
+                    auto& slot = slots[slot_index];
+                    if (slot.stage != Stage::FREE)
+                    {
+                        continue;
+                    }
+                    slot = Slot{};
+                    slot.stage = Stage::OPEN;
+                    slot.index = next_file;
+                    next_file += 1;
+                    in_flight += 1;
+
+                    auto* sqe = ring.Queue(IORING_OP_OPENAT, AT_FDCWD, slot_index);
+                    sqe->addr = reinterpret_cast<__u64>(filenames[slot.index].c_str());
+                    sqe->open_flags = O_RDONLY | O_CLOEXEC;
+                }
+
+                if (ring.SubmitAndWait() == false)
+                {
+                    // the ring is broken, load whatever is left without it
+                    auto give_up = [&](Slot& slot, int opened) {
+                        if (slot.stage == Stage::OPEN || slot.stage == Stage::READ)
+                        {
+                            deliver_fallback(slot.index);
+                        }
+                        if (opened >= 0)
+                        {
+                            close(opened);
+                        }
+                        slot.stage = Stage::FREE;
+                    };
+
+                    // operations the kernel already took may still write into the slot buffers or use the files,
+                    // so wait for all of them before a file is closed or a buffer freed
+                    const auto busy = static_cast<std::size_t>(std::count_if(slots.begin(), slots.end(), [](const Slot& slot) { return slot.stage != Stage::FREE; }));
+                    auto submitted = busy - ring.Unsubmitted();
+                    while (submitted > 0)
+                    {
+                        ring.Reap([&](__u64 user_data, __s32 res) {
+                            auto& slot = slots[static_cast<std::size_t>(user_data)];
+                            give_up(slot, slot.stage == Stage::OPEN ? res : slot.stage == Stage::READ ? slot.fd : -1);
+                            submitted -= 1;
+                        });
+                        if (submitted > 0 && ring.Wait() == false)
+                        {
+                            // the completions still arrive in the queue, only entering the ring fails
+                            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                        }
+                    }
+                    for (auto& slot : slots)
+                    {
+                        if (slot.stage != Stage::FREE)
+                        {
+                            give_up(slot, slot.stage == Stage::OPEN ? -1 : slot.fd);
+                        }
+                    }
+                    for (; next_file < filenames.size(); next_file += 1)
+                    {
+                        deliver_fallback(next_file);
+                    }
+                    pool->Wait();
+                    return true;
+                }
+
+                ring.Reap([&](__u64 user_data, __s32 res) {
+                    const auto slot_index = static_cast<std::size_t>(user_data);
+                    auto& slot = slots[slot_index];
+                    switch (slot.stage)
+                    {
+                    case Stage::OPEN:
+                    {
+                        struct stat info;
+                        if (res < 0 || fstat(res, &info) != 0)
+                        {
+                            // opcode not supported or the file can't be opened, let the regular loader handle it
+                            if (res >= 0)
+                            {
+                                close(res);
+                            }
+                            deliver_fallback(slot.index);
+                            slot.stage = Stage::FREE;
+                            in_flight -= 1;
+                            return;
+                        }
+                        slot.fd = res;
+                        slot.data.resize(static_cast<std::size_t>(info.st_size));
+                        if (slot.data.empty())
+                        {
+                            deliver(slot.index, std::string{});
+                            queue_close(slot_index);
+                        }
+                        else
+                        {
+                            queue_read(slot_index);
+                        }
+                        return;
+                    }
+                    case Stage::READ:
+                        if (res > 0)
+                        {
+                            slot.read += static_cast<std::size_t>(res);
+                            if (slot.read < slot.data.size())
+                            {
+                                queue_read(slot_index);
+                                return;
+                            }
+                        }
+                        else if (res < 0)
+                        {
+                            deliver_fallback(slot.index);
+                            queue_close(slot_index);
+                            return;
+                        }
+                        slot.data.resize(slot.read);
+                        deliver(slot.index, std::move(slot.data));
+                        queue_close(slot_index);
+                        return;
+                    case Stage::CLOSE:
+                        slot.stage = Stage::FREE;
+                        in_flight -= 1;
+                        return;
+                    case Stage::FREE:
+                        return;
+                    }
+                });
+            }
+
+            pool->Wait();
+            return true;
+        }
+#endif
+    }
+
+    BulkReadOptions::BulkReadOptions()
+        : use_io_uring(true)
+        , queue_depth(64)
+    {
+    }
+
+    void LoadFiles(const std::vector<std::string>& filenames, [[maybe_unused]] const BulkReadOptions& options, ThreadPool* pool, const OnFileLoaded& on_loaded)
+    {
+#if defined(INFOFILE_IO_URING)
+        if (options.use_io_uring && options.queue_depth > 0 && LoadFilesWithUring(filenames, options.queue_depth, pool, on_loaded))
+        {
+            return;
+        }
+#endif
+        LoadFilesOnPool(filenames, pool, on_loaded);
+    }
+
+    bool IsIoUringAvailable()
+    {
+#if defined(INFOFILE_IO_URING)
+        Uring ring;
+        return ring.Setup(1);
+#else
+        return false;
+#endif
+    }
+}
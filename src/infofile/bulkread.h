@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace infofile
+{
+    struct ThreadPool;
+
+    struct BulkReadOptions
+    {
+        BulkReadOptions();
+
+        /** Use io_uring to open and read the files when available, otherwise every file is read by a task on the pool.
+        */
+        bool use_io_uring;
+
+        /** Maximum number of files being opened or read at the same time with io_uring.
+        */
+        unsigned queue_depth;
+    };
+
+    /** The content of a file that is done loading, a file that couldn't be read is empty.
+    Called on the pool, in any order.
+    */
+    using OnFileLoaded = std::function<void(std::size_t index, std::string data)>;
+
+    /** Load the content of all files, each file is passed to on_loaded on the pool as soon as it's loaded.
+    Returns when all files are loaded and handled.
+    */
+    void LoadFiles(const std::vector<std::string>& filenames, const BulkReadOptions& options, ThreadPool* pool, const OnFileLoaded& on_loaded);
+
+    /** Return true if io_uring can be used on this system.
+    */
+    bool IsIoUringAvailable();
+}
@@ -0,0 +1,102 @@
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+
+#include "catch.hpp"
+#include "catchy/stringeq.h"
+#include "fmt/core.h"
+#include "infofile/bulkread.h"
+#include "infofile/infofile.h"
+#include "infofile/threadpool.h"
+
+using namespace infofile;
+
+namespace
+{
+    void WriteFile(const std::filesystem::path& path, const std::string& content)
+    {
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream f{path, std::ios::binary};
+        f << content;
+    }
+}
+
+TEST_CASE("load files", "[bulkread]")
+{
+    const auto dir = std::filesystem::temp_directory_path() / "infofile_test_load_files";
+    std::vector<std::string> filenames;
+    for (int i = 0; i < 10; i += 1)
+    {
+        const auto path = dir / fmt::format("{}.info", i);
+        WriteFile(path, std::string(static_cast<std::size_t>(i) * 1000, 'a'));
+        filenames.emplace_back(path.string());
+    }
+    filenames.emplace_back((dir / "missing.info").string());
+
+    for (const auto use_io_uring : {true, false})
+    {
+        BulkReadOptions options;
+        options.use_io_uring = use_io_uring;
+        options.queue_depth = 4;
+
+        std::mutex mutex;
+        std::vector<std::string> loaded(filenames.size(), "not loaded");
+        ThreadPool pool{2};
+        LoadFiles(filenames, options, &pool, [&](std::size_t index, std::string data) {
+            std::unique_lock<std::mutex> lock(mutex);
+            loaded[index] = std::move(data);
+        });
+
+        for (std::size_t i = 0; i < 10; i += 1)
+        {
+            CHECK(i * 1000 == loaded[i].size());
+        }
+        CHECK(loaded[10].empty());
+    }
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("read directory", "[bulkread]")
+{
+    const auto dir = std::filesystem::temp_directory_path() / "infofile_test_read_directory";
+    WriteFile(dir / "b.info", "key b");
+    WriteFile(dir / "a.info", "key a");
+    WriteFile(dir / "sub" / "c.info", "key \"c");
+    WriteFile(dir / "ignored.txt", "key ignored");
+
+    for (const auto use_io_uring : {true, false})
+    {
+        ReadDirectoryOptions options;
+        options.threads = 2;
+        options.extension = ".info";
+        options.use_io_uring = use_io_uring;
+        const auto results = ReadDirectory(dir.string(), options);
+
+        REQUIRE(3 == results.size());
+        CHECK((dir / "a.info").string() == results[0].filename);
+        CHECK((dir / "b.info").string() == results[1].filename);
+        CHECK((dir / "sub" / "c.info").string() == results[2].filename);
+
+        const std::vector<std::string> values = {"a", "b", "c"};
+        for (std::size_t i = 0; i < 3; i += 1)
+        {
+            REQUIRE(results[i].root != nullptr);
+            REQUIRE(1 == results[i].root->children.size());
+            CHECK(values[i] == results[i].root->children[0]->value);
+            CHECK(results[i].errors.size() == (i == 2 ? 1 : 0));
+        }
+    }
+
+    // a missing directory is reported instead of giving a empty result
+    {
+        const auto missing = (dir / "missing").string();
+        const auto results = ReadDirectory(missing, ReadDirectoryOptions{});
+        REQUIRE(1 == results.size());
+        CHECK(missing == results[0].filename);
+        CHECK(results[0].root == nullptr);
+        CHECK(1 == results[0].errors.size());
+    }
+
+    std::filesystem::remove_all(dir);
+}
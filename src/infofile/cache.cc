@@ -0,0 +1,201 @@
+#include "infofile/cache.h"
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <thread>
+
+#include "fmt/core.h"
+#include "infofile/binary.h"
+#include "infofile/hash.h"
+#include "infofile/infofile.h"
+
+namespace infofile
+{
+    namespace
+    {
+        constexpr char MAGIC[] = {'I', 'N', 'F', 'C'};
+        constexpr std::uint64_t VERSION = 1;
+
+        struct CacheKey
+        {
+            std::uint64_t size;
+            std::uint64_t modified;
+            std::uint64_t hash;
+        };
+
+        std::string ReadAll(const std::filesystem::path& path)
+        {
+            std::ifstream stream(path, std::ios::binary);
+            std::ostringstream data;
+            data << stream.rdbuf();
+            return data.str();
+        }
+
+        void Write64(std::string* out, std::uint64_t value)
+        {
+            for (int i = 0; i < 8; i += 1)
+            {
+                out->push_back(static_cast<char>((value >> (i * 8)) & 0xFF));
+            }
+        }
+
+        struct SnapshotReader
+        {
+            bool Read64(std::uint64_t* value)
+            {
+                if (size - position < 8)
+                {
+                    return false;
+                }
+                *value = 0;
+                for (int i = 7; i >= 0; i -= 1)
+                {
+                    *value = (*value << 8) | static_cast<unsigned char>(data[position + static_cast<std::size_t>(i)]);
+                }
+                position += 8;
+                return true;
+            }
+
+            bool ReadString(std::string* str)
+            {
+                std::uint64_t length = 0;
+                if (Read64(&length) == false || length > size - position)
+                {
+                    return false;
+                }
+                str->assign(data + position, length);
+                position += length;
+                return true;
+            }
+
+            const char* data;
+            std::size_t size;
+            std::size_t position;
+        };
+
+        std::string WriteSnapshot(const CacheKey& key, const std::vector<std::string>& errors, std::shared_ptr<Node> root)
+        {
+            std::string out;
+            out.append(MAGIC, sizeof(MAGIC));
+            Write64(&out, VERSION);
+            Write64(&out, key.size);
+            Write64(&out, key.modified);
+            Write64(&out, key.hash);
+            Write64(&out, errors.size());
+            for (const auto& e : errors)
+            {
+                Write64(&out, e.size());
+                out.append(e);
+            }
+            out.append(WriteBinary(root));
+            return out;
+        }
+
+        /** Returns null if the snapshot is missing, for another version of the file or broken.
+        */
+        std::shared_ptr<Node> ReadSnapshot(const std::string& snapshot, const CacheKey& key, std::vector<std::string>* errors)
+        {
+            if (snapshot.size() < sizeof(MAGIC) || std::memcmp(snapshot.data(), MAGIC, sizeof(MAGIC)) != 0)
+            {
+                return nullptr;
+            }
+
+            auto reader = SnapshotReader{snapshot.data(), snapshot.size(), sizeof(MAGIC)};
+            CacheKey stored = {0, 0, 0};
+            std::uint64_t version = 0;
+            std::uint64_t error_count = 0;
+            if (!reader.Read64(&version) || !reader.Read64(&stored.size) || !reader.Read64(&stored.modified) || !reader.Read64(&stored.hash) || !reader.Read64(&error_count))
+            {
+                return nullptr;
+            }
+            if (version != VERSION || stored.size != key.size || stored.modified != key.modified || stored.hash != key.hash)
+            {
+                return nullptr;
+            }
+
+            std::vector<std::string> stored_errors;
+            for (std::uint64_t i = 0; i < error_count; i += 1)
+            {
+                std::string e;
+                if (reader.ReadString(&e) == false)
+                {
+                    return nullptr;
+                }
+                stored_errors.emplace_back(std::move(e));
+            }
+
+            std::vector<std::string> binary_errors;
+            auto root = ReadBinary("cache", snapshot.substr(reader.position), &binary_errors);
+            if (root == nullptr)
+            {
+                return nullptr;
+            }
+
+            errors->insert(errors->end(), stored_errors.begin(), stored_errors.end());
+            return root;
+        }
+    }
+
+    std::shared_ptr<Node> ReadFileCached(const std::string& filename, std::vector<std::string>* errors, const std::string& cache_directory)
+    {
+        std::error_code error;
+        const auto path = std::filesystem::absolute(filename, error);
+        const auto file_size = std::filesystem::file_size(path, error);
+        if (error)
+        {
+            return ReadFile(filename, errors);
+        }
+        const auto modified = std::filesystem::last_write_time(path, error);
+        if (error)
+        {
+            return ReadFile(filename, errors);
+        }
+
+        const auto content = ReadAll(path);
+        const auto key = CacheKey{
+            file_size,
+            static_cast<std::uint64_t>(modified.time_since_epoch().count()),
+            Hash64(content.data(), content.size())};
+
+        // the errors contain the filename as given, so every spelling of the path gets it's own snapshot
+        const auto snapshot_name = path.string() + '\n' + filename;
+        const auto snapshot_path = std::filesystem::path(cache_directory) / fmt::format("{:016x}.cache", Hash64(snapshot_name.data(), snapshot_name.size()));
+
+        if (auto cached = ReadSnapshot(ReadAll(snapshot_path), key, errors); cached != nullptr)
+        {
+            return cached;
+        }
+
+        std::vector<std::string> parse_errors;
+        auto root = Parse(filename, content, &parse_errors);
+
+        // write to a temporary file first so a reader never sees a half written snapshot
+        std::filesystem::create_directories(cache_directory, error);
+        auto temp_path = snapshot_path;
+        // the thread id is only unique within a process, the random part keeps other processes from writing the same file
+        temp_path += fmt::format(".{:x}.{:x}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()), std::random_device{}());
+        auto written = false;
+        {
+            const auto snapshot = WriteSnapshot(key, parse_errors, root);
+            std::ofstream stream(temp_path, std::ios::binary);
+            stream.write(snapshot.data(), static_cast<std::streamsize>(snapshot.size()));
+            stream.close();
+            written = stream.good();
+        }
+        if (written)
+        {
+            std::filesystem::rename(temp_path, snapshot_path, error);
+        }
+        if (written == false || error)
+        {
+            std::filesystem::remove(temp_path, error);
+        }
+
+        errors->insert(errors->end(), parse_errors.begin(), parse_errors.end());
+        return root;
+    }
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "infofile/node.h"
+
+namespace infofile
+{
+    /** Like ReadFile but a binary snapshot of the parsed tree and the errors is stored in cache_directory.
+    As long as the path, size, modification time and content of the file are the same the tree is loaded
+    from the snapshot and the errors are replayed instead of parsing the file again.
+    The path is used as given, different spellings of the same path get their own snapshots.
+    */
+    std::shared_ptr<Node> ReadFileCached(const std::string& filename, std::vector<std::string>* errors, const std::string& cache_directory);
+}
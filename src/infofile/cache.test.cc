@@ -0,0 +1,110 @@
+#include <filesystem>
+#include <fstream>
+
+#include "catch.hpp"
+#include "catchy/stringeq.h"
+#include "infofile/cache.h"
+#include "infofile/infofile.h"
+
+using namespace infofile;
+
+namespace
+{
+    void WriteFile(const std::filesystem::path& path, const std::string& content)
+    {
+        std::ofstream f{path, std::ios::binary};
+        f << content;
+    }
+
+    std::vector<std::filesystem::path> ListFiles(const std::filesystem::path& dir)
+    {
+        std::vector<std::filesystem::path> r;
+        for (const auto& entry : std::filesystem::directory_iterator(dir))
+        {
+            r.emplace_back(entry.path());
+        }
+        return r;
+    }
+}
+
+TEST_CASE("cached read", "[cache]")
+{
+    const auto dir = std::filesystem::temp_directory_path() / "infofile_test_cache";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir / "src");
+    const auto file = (dir / "src" / "config.info").string();
+    const auto cache = (dir / "cache").string();
+
+    WriteFile(file, "a b; c { d e } f \"missing end");
+
+    std::vector<std::string> expected_errors;
+    const auto expected = ReadFile(file, &expected_errors);
+    REQUIRE(1 == expected_errors.size());
+
+    std::vector<std::string> first_errors;
+    const auto first = ReadFileCached(file, &first_errors, cache);
+    CHECK(catchy::StringEq(first_errors, expected_errors));
+    CHECK(catchy::StringEq(PrintToString(PrintOptions{}, first), PrintToString(PrintOptions{}, expected)));
+
+    const auto snapshots = ListFiles(cache);
+    REQUIRE(1 == snapshots.size());
+    const auto snapshot_time = std::filesystem::last_write_time(snapshots[0]);
+
+    SECTION("unchanged file is loaded from the snapshot")
+    {
+        std::vector<std::string> errors;
+        const auto second = ReadFileCached(file, &errors, cache);
+        CHECK(catchy::StringEq(errors, expected_errors));
+        CHECK(catchy::StringEq(PrintToString(PrintOptions{}, second), PrintToString(PrintOptions{}, expected)));
+        CHECK(snapshot_time == std::filesystem::last_write_time(snapshots[0]));
+    }
+
+    SECTION("changed content with same size and time is parsed again")
+    {
+        const auto modified = std::filesystem::last_write_time(file);
+        WriteFile(file, "a x; c { d e } f \"missing end");
+        std::filesystem::last_write_time(file, modified);
+
+        std::vector<std::string> errors;
+        const auto second = ReadFileCached(file, &errors, cache);
+        REQUIRE(second != nullptr);
+        REQUIRE(3 == second->children.size());
+        CHECK("x" == second->children[0]->value);
+        CHECK(1 == ListFiles(cache).size());
+    }
+
+    SECTION("errors use the filename of the caller")
+    {
+        // a relative path has the same absolute path as the one that wrote the snapshot
+        const auto cwd = std::filesystem::current_path();
+        std::filesystem::current_path(dir / "src");
+        const std::string other = "config.info";
+        std::vector<std::string> other_expected;
+        ReadFile(other, &other_expected);
+
+        std::vector<std::string> errors;
+        ReadFileCached(other, &errors, cache);
+        CHECK(catchy::StringEq(errors, other_expected));
+
+        errors.clear();
+        ReadFileCached(other, &errors, cache);
+        CHECK(catchy::StringEq(errors, other_expected));
+        std::filesystem::current_path(cwd);
+
+        errors.clear();
+        ReadFileCached(file, &errors, cache);
+        CHECK(catchy::StringEq(errors, expected_errors));
+    }
+
+    SECTION("broken snapshot is replaced")
+    {
+        WriteFile(snapshots[0], "garbage");
+
+        std::vector<std::string> errors;
+        const auto second = ReadFileCached(file, &errors, cache);
+        CHECK(catchy::StringEq(errors, expected_errors));
+        CHECK(catchy::StringEq(PrintToString(PrintOptions{}, second), PrintToString(PrintOptions{}, expected)));
+    }
+
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,307 @@
+#include "infofile/compact.h"
+
+#include <string_view>
+
+#include "infofile/chars.h"
+#include "infofile/lexer.h"
+#include "infofile/printbuffer.h"
+#include "infofile/reader.h"
+
+namespace infofile
+{
+    namespace
+    {
+        bool IsIdent(std::string_view str)
+        {
+            if (str.empty() || IsIdentChar(str[0], true) == false)
+            {
+                return false;
+            }
+            for (const char c : str)
+            {
+                if (IsIdentChar(c, false) == false)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /** Numbers and colors can be written without quotes if the lexer reads them back exactly.
+        */
+        bool IsRawNumber(std::string_view str)
+        {
+            if (str.empty() || (IsNumber(str[0]) == false && str[0] != '-' && str[0] != '#'))
+            {
+                return false;
+            }
+            std::vector<std::string> errors;
+            auto reader = MemoryReader{"", str.data(), str.size()};
+            auto lexer = Lexer{&reader, &errors};
+            const auto token = lexer.Read();
+            return token.type == TokenType::IDENT && token.value == str && lexer.Peek().type == TokenType::ENDOFFILE && errors.empty();
+        }
+
+        bool CanBeVerbatim(std::string_view str)
+        {
+            for (const char c : str)
+            {
+                switch (c)
+                {
+                case '\0':
+                case '\n':
+                case '\r':
+                case '\t':
+                    return false;
+                default:
+                    break;
+                }
+            }
+            return true;
+        }
+
+        const char* EscapeInString(char c, char quote)
+        {
+            switch (c)
+            {
+            case '\0':
+                return "\\0";
+            case '\n':
+                return "\\n";
+            case '\r':
+                return "\\r";
+            case '\t':
+                return "\\t";
+            case '\\':
+                return "\\\\";
+            case '"':
+                return quote == '"' ? "\\\"" : nullptr;
+            case '\'':
+                return quote == '\'' ? "\\'" : nullptr;
+            default:
+                return nullptr;
+            }
+        }
+
+        std::size_t QuotedSize(std::string_view str, char quote)
+        {
+            auto size = str.size() + 2;
+            for (const char c : str)
+            {
+                if (EscapeInString(c, quote) != nullptr)
+                {
+                    size += 1;
+                }
+            }
+            return size;
+        }
+
+        std::size_t VerbatimSize(std::string_view str, char quote)
+        {
+            auto size = str.size() + 3;
+            for (const char c : str)
+            {
+                if (c == quote)
+                {
+                    size += 1;
+                }
+            }
+            return size;
+        }
+
+        bool StartsWithBracket(const Node& node)
+        {
+            return node.name.empty() && node.value.empty() && node.children.empty() == false;
+        }
+
+        bool CanBeArray(const Node& node)
+        {
+            for (const auto& child : node.children)
+            {
+                if (child->name.empty() == false || (child->children.empty() == false && child->value.empty() == false))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        struct CompactPrinter
+        {
+            explicit CompactPrinter(PrintBuffer* b)
+                : buffer(b)
+                , last(0)
+                , last_raw(false)
+            {
+            }
+
+            void WriteToken(std::string_view text, bool raw)
+            {
+                const auto next = text[0];
+                const auto joins_raw = last_raw && (IsIdentChar(next, false) || next == '-' || next == '#');
+                const auto joins_quote = (last == '"' || last == '\'') && next == last;
+                if (joins_raw || joins_quote)
+                {
+                    buffer->Write(' ');
+                }
+                buffer->Write(text);
+                last = text.back();
+                last_raw = raw;
+            }
+
+            void WriteString(std::string_view str)
+            {
+                if (IsIdent(str) || IsRawNumber(str))
+                {
+                    WriteToken(str, true);
+                    return;
+                }
+
+                // pick the shortest of the quoted and verbatim strings, ties go to the first
+                char quote = '"';
+                auto best = QuotedSize(str, '"');
+                bool verbatim = false;
+                if (QuotedSize(str, '\'') < best)
+                {
+                    quote = '\'';
+                    best = QuotedSize(str, '\'');
+                }
+                if (CanBeVerbatim(str))
+                {
+                    for (const char q : {'"', '\''})
+                    {
+                        if (VerbatimSize(str, q) < best)
+                        {
+                            quote = q;
+                            best = VerbatimSize(str, q);
+                            verbatim = true;
+                        }
+                    }
+                }
+
+                token.clear();
+                if (verbatim)
+                {
+                    token.push_back('@');
+                }
+                token.push_back(quote);
+                for (const char c : str)
+                {
+                    const auto* escape = verbatim ? nullptr : EscapeInString(c, quote);
+                    if (escape != nullptr)
+                    {
+                        token.append(escape);
+                    }
+                    else
+                    {
+                        token.push_back(c);
+                        if (verbatim && c == quote)
+                        {
+                            token.push_back(c);
+                        }
+                    }
+                }
+                token.push_back(quote);
+                WriteToken(token, false);
+            }
+
+            void WriteSymbol(char c)
+            {
+                buffer->Write(c);
+                last = c;
+                last_raw = false;
+            }
+
+            void WriteMembers(const Node& node, bool root)
+            {
+                const auto& children = node.children;
+                for (std::size_t i = 0; i < children.size(); i += 1)
+                {
+                    const auto& child = *children[i];
+
+                    // a leading bracket would make the root a struct or array
+                    if (StartsWithBracket(child) && (root == false || i > 0))
+                    {
+                        WriteContainer(child);
+                        continue;
+                    }
+
+                    WriteString(child.name);
+                    if (child.value.empty() == false)
+                    {
+                        WriteString(child.value);
+                    }
+                    if (child.children.empty() == false)
+                    {
+                        WriteContainer(child);
+                    }
+                    else if (i + 1 < children.size() && (child.value.empty() || StartsWithBracket(*children[i + 1])))
+                    {
+                        // the next node would become the value or the children
+                        WriteSymbol(';');
+                    }
+                }
+            }
+
+            void WriteContainer(const Node& node)
+            {
+                if (CanBeArray(node))
+                {
+                    WriteSymbol('[');
+                    for (const auto& child : node.children)
+                    {
+                        if (child->children.empty())
+                        {
+                            WriteString(child->value);
+                        }
+                        else
+                        {
+                            WriteContainer(*child);
+                        }
+                    }
+                    WriteSymbol(']');
+                }
+                else
+                {
+                    WriteSymbol('{');
+                    WriteMembers(node, false);
+                    WriteSymbol('}');
+                }
+            }
+
+            PrintBuffer* buffer;
+            char last;
+            bool last_raw;
+            std::string token;
+        };
+    }
+
+    void PrintCompact(PrintBuffer* buffer, const Node& node)
+    {
+        CompactPrinter printer{buffer};
+        if (node.name.empty() == false || node.value.empty() == false)
+        {
+            Node root;
+            root.children.emplace_back(std::make_shared<Node>(node));
+            printer.WriteMembers(root, true);
+        }
+        else if (node.children.empty() == false && CanBeArray(node))
+        {
+            printer.WriteContainer(node);
+        }
+        else
+        {
+            printer.WriteMembers(node, true);
+        }
+    }
+
+    std::string PrintToStringCompact(std::shared_ptr<Node> node)
+    {
+        std::string printed;
+        {
+            PrintBuffer buffer{StringSink(&printed)};
+            PrintCompact(&buffer, *node);
+        }
+        return printed;
+    }
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "infofile/node.h"
+
+namespace infofile
+{
+    struct PrintBuffer;
+
+    /** Print a root with as few bytes as possible, parsing the output gives the same tree.
+    There is no whitespace, separators only where the next node would otherwise be read as part of the previous,
+    empty values are left out, children without names are written as arrays and every string is written
+    as a ident, number, quoted or verbatim string, whichever is shortest.
+    A root with a name or value is printed as the only child of a empty root, like Print does.
+    */
+    void PrintCompact(PrintBuffer* buffer, const Node& node);
+
+    std::string PrintToStringCompact(std::shared_ptr<Node> node);
+}
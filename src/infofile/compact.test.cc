@@ -0,0 +1,77 @@
+#include "catch.hpp"
+#include "catchy/stringeq.h"
+#include "infofile/compact.h"
+#include "infofile/infofile.h"
+
+using namespace infofile;
+
+namespace
+{
+    std::string Compact(const std::string& src)
+    {
+        std::vector<std::string> errors;
+        return PrintToStringCompact(Parse("inline", src, &errors));
+    }
+
+    std::string RoundTrip(std::shared_ptr<Node> root)
+    {
+        std::vector<std::string> errors;
+        const auto parsed = Parse("compact", PrintToStringCompact(root), &errors);
+        CHECK(errors.empty());
+        return PrintToString(PrintOptions{}, parsed);
+    }
+}
+
+TEST_CASE("compact", "[compact]")
+{
+    SECTION("separators only where needed")
+    {
+        CHECK(catchy::StringEq(Compact("a b; c d"), "a b c d"));
+        CHECK(catchy::StringEq(Compact("a; b c"), "a;b c"));
+        CHECK(catchy::StringEq(Compact("a { b c; d }; e"), "a{b c d}e"));
+        CHECK(catchy::StringEq(Compact("a b; { c d }"), "a b;{c d}"));
+    }
+
+    SECTION("arrays")
+    {
+        CHECK(catchy::StringEq(Compact("a [1, 2, x]"), "a[1 2 x]"));
+        CHECK(catchy::StringEq(Compact("a { \"\" 1; \"\" \"b c\" }"), "a[1\"b c\"]"));
+        CHECK(catchy::StringEq(Compact("[[a], [b, \"\"]]"), "[[a][b\"\"]]"));
+    }
+
+    SECTION("root")
+    {
+        CHECK(catchy::StringEq(Compact(""), ""));
+        CHECK(catchy::StringEq(Compact("\"\" \"\" { a b } c d"), "\"\"{a b}c d"));
+    }
+
+    SECTION("strings")
+    {
+        CHECK(catchy::StringEq(Compact("a \"b c\""), "a\"b c\""));
+        CHECK(catchy::StringEq(Compact("a \"say \\\"hi\\\"\""), "a'say \"hi\"'"));
+        CHECK(catchy::StringEq(Compact("a @\"c:\\dir\\file\""), "a @\"c:\\dir\\file\""));
+        CHECK(catchy::StringEq(Compact("a \"\\n\\r\\t\\0\""), "a\"\\n\\r\\t\\0\""));
+        CHECK(catchy::StringEq(Compact("a -1.5f; b 0x1F; c #fff"), "a -1.5f b 0x1F c #fff"));
+        CHECK(catchy::StringEq(Compact("a \"1x\""), "a\"1x\""));
+    }
+
+    SECTION("round trip")
+    {
+        auto root = std::make_shared<Node>();
+        root->children.emplace_back(std::make_shared<Node>("", ""));
+        root->children.emplace_back(std::make_shared<Node>("", "\"\"\""));
+        root->children.emplace_back(std::make_shared<Node>("x", ""));
+        root->children.back()->children.emplace_back(std::make_shared<Node>("", "y"));
+        root->children.back()->children.back()->children.emplace_back(std::make_shared<Node>("z", "''"));
+        root->children.emplace_back(std::make_shared<Node>("a.b@c", "\\\\"));
+        CHECK(catchy::StringEq(RoundTrip(root), PrintToString(PrintOptions{}, root)));
+    }
+
+    SECTION("print options")
+    {
+        std::vector<std::string> errors;
+        PrintOptions options;
+        options.compact = true;
+        CHECK(catchy::StringEq(PrintToString(options, Parse("inline", "a { b c }", &errors)), "a{b c}"));
+    }
+}
@@ -0,0 +1,156 @@
+#include "infofile/confighandle.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "infofile/infofile.h"
+
+namespace infofile
+{
+    // All atomics use the default sequentially consistent ordering.
+    // A reader stores the global epoch in it's slot before loading the current version, and a writer swaps the version
+    // before incrementing the epoch. So a reader that could have loaded a replaced version has a epoch no later than
+    // the one the version was retired at, and the version is only freed when all active readers have a later epoch.
+
+    ConfigHandle::ConfigHandle(std::shared_ptr<const Node> root)
+        : current(new ConfigVersion{std::move(root)})
+        , epoch(0)
+    {
+    }
+
+    ConfigHandle::~ConfigHandle()
+    {
+        WaitForReload();
+        delete current.load();
+    }
+
+    void ConfigHandle::Publish(std::shared_ptr<const Node> root)
+    {
+        auto version = std::make_unique<ConfigVersion>(ConfigVersion{std::move(root)});
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto* old = current.exchange(version.release());
+            const auto retired_at = epoch.fetch_add(1);
+            retired.emplace_back(Retired{retired_at, std::unique_ptr<ConfigVersion>(old)});
+        }
+        Reclaim();
+    }
+
+    void ConfigHandle::Reload(const std::string& filename, std::function<void(const std::vector<std::string>&)> on_done)
+    {
+        std::lock_guard<std::mutex> lock(reload_mutex);
+        if (reload.joinable())
+        {
+            reload.join();
+        }
+        reload = std::thread([this, filename, on_done]() {
+            std::vector<std::string> errors;
+            auto root = ReadFile(filename, &errors);
+            if (errors.empty())
+            {
+                Publish(std::move(root));
+            }
+            if (on_done)
+            {
+                on_done(errors);
+            }
+        });
+    }
+
+    void ConfigHandle::WaitForReload()
+    {
+        std::lock_guard<std::mutex> lock(reload_mutex);
+        if (reload.joinable())
+        {
+            reload.join();
+        }
+    }
+
+    void ConfigHandle::Reclaim()
+    {
+        std::vector<Retired> freed;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto oldest = ConfigReader::IDLE;
+            for (const auto* reader : readers)
+            {
+                oldest = std::min(oldest, reader->epoch.load());
+            }
+            const auto still_visible = std::stable_partition(retired.begin(), retired.end(), [oldest](const Retired& r) { return r.epoch >= oldest; });
+            std::move(still_visible, retired.end(), std::back_inserter(freed));
+            retired.erase(still_visible, retired.end());
+        }
+        // the roots are destroyed here, outside the lock
+    }
+
+    std::size_t ConfigHandle::RetiredCount()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return retired.size();
+    }
+
+    ConfigSnapshot::ConfigSnapshot(ConfigReader* r, const ConfigVersion* v)
+        : reader(r)
+        , version(v)
+    {
+    }
+
+    ConfigSnapshot::~ConfigSnapshot()
+    {
+        if (reader == nullptr)
+        {
+            return;
+        }
+        reader->active_snapshots -= 1;
+        if (reader->active_snapshots == 0)
+        {
+            reader->epoch.store(ConfigReader::IDLE);
+        }
+    }
+
+    ConfigSnapshot::ConfigSnapshot(ConfigSnapshot&& other) noexcept
+        : reader(other.reader)
+        , version(other.version)
+    {
+        other.reader = nullptr;
+        other.version = nullptr;
+    }
+
+    const Node& ConfigSnapshot::Root() const
+    {
+        return *version->root;
+    }
+
+    std::shared_ptr<const Node> ConfigSnapshot::Share() const
+    {
+        return version->root;
+    }
+
+    ConfigReader::ConfigReader(ConfigHandle* h)
+        : handle(h)
+        , epoch(IDLE)
+        , active_snapshots(0)
+    {
+        std::lock_guard<std::mutex> lock(handle->mutex);
+        handle->readers.emplace_back(this);
+    }
+
+    ConfigReader::~ConfigReader()
+    {
+        {
+            std::lock_guard<std::mutex> lock(handle->mutex);
+            handle->readers.erase(std::find(handle->readers.begin(), handle->readers.end(), this));
+        }
+        handle->Reclaim();
+    }
+
+    ConfigSnapshot ConfigReader::Read()
+    {
+        if (active_snapshots == 0)
+        {
+            epoch.store(handle->epoch.load());
+        }
+        active_snapshots += 1;
+        return ConfigSnapshot{this, handle->current.load()};
+    }
+}
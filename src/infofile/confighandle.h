@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "infofile/node.h"
+
+namespace infofile
+{
+    struct ConfigReader;
+
+    struct ConfigVersion
+    {
+        std::shared_ptr<const Node> root;
+    };
+
+    /** Holds the current version of a configuration that is read from many threads and replaced now and then.
+    Readers never lock or wait, a replaced version is freed once no reader that could have seen it is active.
+    */
+    struct ConfigHandle
+    {
+        explicit ConfigHandle(std::shared_ptr<const Node> root);
+
+        /** Waits for a running reload, all readers must be destroyed before the handle.
+        */
+        ~ConfigHandle();
+
+        ConfigHandle(const ConfigHandle&) = delete;
+        void operator=(const ConfigHandle&) = delete;
+
+        /** Make a new root the current version.
+        */
+        void Publish(std::shared_ptr<const Node> root);
+
+        /** Parse a file on a background thread and publish it if there were no errors.
+        on_done is called on the background thread with the errors, a reload that is already running is waited for.
+        */
+        void Reload(const std::string& filename, std::function<void(const std::vector<std::string>&)> on_done = nullptr);
+        void WaitForReload();
+
+        /** Free the replaced versions that no reader can see anymore.
+        This is done when publishing and when a reader is destroyed.
+        */
+        void Reclaim();
+
+        /** The number of replaced versions that are still waiting to be freed.
+        */
+        std::size_t RetiredCount();
+
+        struct Retired
+        {
+            std::uint64_t epoch;
+            std::unique_ptr<ConfigVersion> version;
+        };
+
+        std::atomic<ConfigVersion*> current;
+        std::atomic<std::uint64_t> epoch;
+
+        std::mutex mutex;
+        std::vector<ConfigReader*> readers;
+        std::vector<Retired> retired;
+
+        std::mutex reload_mutex;
+        std::thread reload;
+    };
+
+    /** A version of the configuration that stays alive as long as the snapshot does.
+    */
+    struct ConfigSnapshot
+    {
+        ConfigSnapshot(ConfigReader* r, const ConfigVersion* v);
+        ~ConfigSnapshot();
+
+        ConfigSnapshot(ConfigSnapshot&& other) noexcept;
+        ConfigSnapshot(const ConfigSnapshot&) = delete;
+        void operator=(const ConfigSnapshot&) = delete;
+        void operator=(ConfigSnapshot&&) = delete;
+
+        const Node& Root() const;
+
+        /** Keep the root alive after the snapshot is gone, this touches the shared reference count.
+        */
+        std::shared_ptr<const Node> Share() const;
+
+        ConfigReader* reader;
+        const ConfigVersion* version;
+    };
+
+    /** A reader is registered once per thread, taking a snapshot from it is wait free.
+    A reader must only be used from one thread at a time and must outlive it's snapshots.
+    */
+    struct ConfigReader
+    {
+        static constexpr std::uint64_t IDLE = static_cast<std::uint64_t>(-1);
+
+        explicit ConfigReader(ConfigHandle* h);
+        ~ConfigReader();
+
+        ConfigReader(const ConfigReader&) = delete;
+        void operator=(const ConfigReader&) = delete;
+
+        ConfigSnapshot Read();
+
+        ConfigHandle* handle;
+
+        /** The epoch when the oldest active snapshot was taken, or IDLE.
+        */
+        std::atomic<std::uint64_t> epoch;
+        std::size_t active_snapshots;
+    };
+}
@@ -0,0 +1,123 @@
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+#include "catch.hpp"
+#include "catchy/stringeq.h"
+#include "infofile/confighandle.h"
+#include "infofile/infofile.h"
+
+using namespace infofile;
+
+namespace
+{
+    std::shared_ptr<Node> ParseInline(const std::string& src)
+    {
+        std::vector<std::string> errors;
+        return Parse("inline", src, &errors);
+    }
+}
+
+TEST_CASE("config handle", "[confighandle]")
+{
+    ConfigHandle handle{ParseInline("version 1")};
+
+    SECTION("publish")
+    {
+        ConfigReader reader{&handle};
+        CHECK(catchy::StringEq(reader.Read().Root().children[0]->value, "1"));
+        handle.Publish(ParseInline("version 2"));
+        CHECK(catchy::StringEq(reader.Read().Root().children[0]->value, "2"));
+        CHECK(0 == handle.RetiredCount());
+    }
+
+    SECTION("snapshot keeps the version alive")
+    {
+        ConfigReader reader{&handle};
+        {
+            const auto snapshot = reader.Read();
+            handle.Publish(ParseInline("version 2"));
+            handle.Publish(ParseInline("version 3"));
+            CHECK(2 == handle.RetiredCount());
+            CHECK(catchy::StringEq(snapshot.Root().children[0]->value, "1"));
+
+            const auto nested = reader.Read();
+            CHECK(catchy::StringEq(nested.Root().children[0]->value, "3"));
+        }
+        handle.Reclaim();
+        CHECK(0 == handle.RetiredCount());
+    }
+
+    SECTION("shared root outlives the snapshot")
+    {
+        std::shared_ptr<const Node> shared;
+        {
+            ConfigReader reader{&handle};
+            shared = reader.Read().Share();
+        }
+        handle.Publish(ParseInline("version 2"));
+        CHECK(0 == handle.RetiredCount());
+        CHECK(catchy::StringEq(shared->children[0]->value, "1"));
+    }
+
+    SECTION("reload")
+    {
+        const auto path = std::filesystem::temp_directory_path() / "infofile_test_config_handle.info";
+        {
+            std::ofstream f{path, std::ios::binary};
+            f << "version 2";
+        }
+        std::vector<std::string> errors;
+        handle.Reload(path.string(), [&errors](const std::vector<std::string>& e) { errors = e; });
+        handle.WaitForReload();
+        CHECK(errors.empty());
+
+        ConfigReader reader{&handle};
+        CHECK(catchy::StringEq(reader.Read().Root().children[0]->value, "2"));
+
+        {
+            std::ofstream f{path, std::ios::binary};
+            f << "version {";
+        }
+        handle.Reload(path.string(), [&errors](const std::vector<std::string>& e) { errors = e; });
+        handle.WaitForReload();
+        CHECK_FALSE(errors.empty());
+        CHECK(catchy::StringEq(reader.Read().Root().children[0]->value, "2"));
+        std::filesystem::remove(path);
+    }
+
+    SECTION("readers on other threads")
+    {
+        handle.Publish(ParseInline("a 0; b 0"));
+        std::atomic<bool> consistent = true;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 3; t += 1)
+        {
+            threads.emplace_back([&handle, &consistent]() {
+                ConfigReader reader{&handle};
+                for (int i = 0; i < 1000; i += 1)
+                {
+                    const auto snapshot = reader.Read();
+                    const auto& root = snapshot.Root();
+                    if (root.children.size() != 2 || root.children[0]->value != root.children[1]->value)
+                    {
+                        consistent.store(false);
+                    }
+                }
+            });
+        }
+        for (int i = 0; i < 200; i += 1)
+        {
+            const auto value = std::to_string(i);
+            handle.Publish(ParseInline("a " + value + "; b " + value));
+        }
+        for (auto& thread : threads)
+        {
+            thread.join();
+        }
+        handle.Reclaim();
+        CHECK(consistent.load());
+        CHECK(0 == handle.RetiredCount());
+    }
+}
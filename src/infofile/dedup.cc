@@ -0,0 +1,93 @@
+#include "infofile/dedup.h"
+
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "infofile/fingerprint.h"
+
+namespace infofile
+{
+    namespace
+    {
+        // make_shared stores the reference counts next to the node
+        constexpr std::size_t CONTROL_BLOCK_SIZE = 2 * sizeof(long) + sizeof(void*);
+
+        std::size_t EstimateStringSize(const std::string& str)
+        {
+            // short strings are stored inside the string object
+            const auto* begin = reinterpret_cast<const char*>(&str);
+            const auto inline_storage = std::greater_equal<const char*>{}(str.data(), begin) && std::less<const char*>{}(str.data(), begin + sizeof(str));
+            return inline_storage ? 0 : str.capacity() + 1;
+        }
+
+        struct FingerprintHash
+        {
+            std::size_t operator()(const Fingerprint& fingerprint) const
+            {
+                return fingerprint.low;
+            }
+        };
+
+        bool SameNode(const Node& lhs, const Node& rhs)
+        {
+            // the children are already deduplicated so comparing the pointers is enough
+            return lhs.name == rhs.name && lhs.value == rhs.value && lhs.children == rhs.children;
+        }
+
+        struct Deduplicator
+        {
+            std::shared_ptr<Node> Canonical(std::shared_ptr<Node> node)
+            {
+                auto done = visited.find(node.get());
+                if (done != visited.end())
+                {
+                    return done->second;
+                }
+
+                stats.nodes_before += 1;
+                stats.bytes_before += EstimateNodeSize(*node);
+                for (auto& child : node->children)
+                {
+                    child = Canonical(child);
+                }
+
+                auto& candidates = unique[fingerprints.Get(*node)];
+                for (const auto& candidate : candidates)
+                {
+                    if (SameNode(*candidate, *node))
+                    {
+                        // the node is about to be freed, it's address may be reused
+                        fingerprints.fingerprints.erase(node.get());
+                        visited.emplace(node.get(), candidate);
+                        return candidate;
+                    }
+                }
+
+                stats.nodes_after += 1;
+                stats.bytes_after += EstimateNodeSize(*node);
+                candidates.emplace_back(node);
+                visited.emplace(node.get(), node);
+                return node;
+            }
+
+            FingerprintCache fingerprints;
+            std::unordered_map<Fingerprint, std::vector<std::shared_ptr<Node>>, FingerprintHash> unique;
+            std::unordered_map<const Node*, std::shared_ptr<Node>> visited;
+            DeduplicateStats stats;
+        };
+    }
+
+    std::size_t EstimateNodeSize(const Node& node)
+    {
+        return sizeof(Node) + CONTROL_BLOCK_SIZE + EstimateStringSize(node.name) + EstimateStringSize(node.value) + node.children.capacity() * sizeof(std::shared_ptr<Node>);
+    }
+
+    DeduplicateStats Deduplicate(std::shared_ptr<Node> root)
+    {
+        Deduplicator deduplicator;
+        deduplicator.Canonical(root);
+        return deduplicator.stats;
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include "infofile/node.h"
+
+namespace infofile
+{
+    struct DeduplicateStats
+    {
+        /** Distinct nodes before and after deduplicating.
+        */
+        std::size_t nodes_before = 0;
+        std::size_t nodes_after = 0;
+
+        /** Estimated heap usage of the nodes, their strings and child lists.
+        */
+        std::size_t bytes_before = 0;
+        std::size_t bytes_after = 0;
+    };
+
+    /** Make identical subtrees share the same node, returns how much was saved.
+    The tree is changed in place and afterwards a node may have several parents, so treat it as read only
+    and DeepCopy it before changing it.
+    */
+    DeduplicateStats Deduplicate(std::shared_ptr<Node> root);
+
+    /** Estimate the heap memory used by a single node, not counting it's children.
+    */
+    std::size_t EstimateNodeSize(const Node& node);
+}
@@ -0,0 +1,34 @@
+#include "catch.hpp"
+#include "catchy/stringeq.h"
+#include "infofile/dedup.h"
+#include "infofile/infofile.h"
+
+using namespace infofile;
+
+TEST_CASE("deduplicate", "[dedup]")
+{
+    std::vector<std::string> errors;
+    const auto root = Parse("inline", "a { x { y 1; z 2 } } b { x { y 1; z 2 } } c { x { y 1; z 3 } }", &errors);
+    const auto printed = PrintToString(PrintOptions{}, root);
+
+    const auto stats = Deduplicate(root);
+    CHECK(catchy::StringEq(PrintToString(PrintOptions{}, root), printed));
+    CHECK(13 == stats.nodes_before);
+    CHECK(9 == stats.nodes_after);
+    CHECK(stats.bytes_after < stats.bytes_before);
+
+    SECTION("identical subtrees are shared")
+    {
+        CHECK(root->children[0]->children[0] == root->children[1]->children[0]);
+        CHECK(root->children[0]->children[0] != root->children[2]->children[0]);
+        CHECK(root->children[0]->children[0]->children[0] == root->children[2]->children[0]->children[0]);
+    }
+
+    SECTION("again")
+    {
+        const auto again = Deduplicate(root);
+        CHECK(9 == again.nodes_before);
+        CHECK(9 == again.nodes_after);
+        CHECK(again.bytes_before == again.bytes_after);
+    }
+}
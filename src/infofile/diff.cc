@@ -0,0 +1,503 @@
+#include "infofile/diff.h"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <map>
+
+#include "fmt/core.h"
+#include "infofile/binary.h"
+#include "infofile/fingerprint.h"
+
+namespace infofile
+{
+    namespace
+    {
+        constexpr char MAGIC[] = {'I', 'N', 'F', 'P'};
+        constexpr std::size_t VERSION = 1;
+
+        constexpr std::size_t NO_MATCH = static_cast<std::size_t>(-1);
+
+        struct FingerprintLess
+        {
+            bool operator()(const Fingerprint& lhs, const Fingerprint& rhs) const
+            {
+                return lhs.low != rhs.low ? lhs.low < rhs.low : lhs.high < rhs.high;
+            }
+        };
+
+        /** Indices into the sequence that makes up the longest increasing subsequence, NO_MATCH is ignored.
+        */
+        std::vector<bool> LongestIncreasing(const std::vector<std::size_t>& sequence)
+        {
+            std::vector<std::size_t> tails;  // index into sequence of the smallest tail for each length
+            std::vector<std::size_t> previous(sequence.size(), NO_MATCH);
+            for (std::size_t i = 0; i < sequence.size(); i += 1)
+            {
+                if (sequence[i] == NO_MATCH)
+                {
+                    continue;
+                }
+                const auto found = std::lower_bound(tails.begin(), tails.end(), sequence[i], [&sequence](std::size_t tail, std::size_t value) { return sequence[tail] < value; });
+                if (found != tails.begin())
+                {
+                    previous[i] = *(found - 1);
+                }
+                if (found == tails.end())
+                {
+                    tails.emplace_back(i);
+                }
+                else
+                {
+                    *found = i;
+                }
+            }
+
+            std::vector<bool> in_sequence(sequence.size(), false);
+            for (auto i = tails.empty() ? NO_MATCH : tails.back(); i != NO_MATCH; i = previous[i])
+            {
+                in_sequence[i] = true;
+            }
+            return in_sequence;
+        }
+
+        /** Counts the children in front of a slot, slots are ordered like the positions they stand for.
+        A fenwick tree so moving n children is O(n log n) instead of searching and shifting a list.
+        */
+        struct PositionTree
+        {
+            explicit PositionTree(std::size_t size)
+                : counts(size + 1, 0)
+            {
+            }
+
+            void Insert(std::size_t slot)
+            {
+                for (auto i = slot + 1; i < counts.size(); i += i & (~i + 1))
+                {
+                    counts[i] += 1;
+                }
+            }
+
+            void Erase(std::size_t slot)
+            {
+                for (auto i = slot + 1; i < counts.size(); i += i & (~i + 1))
+                {
+                    counts[i] -= 1;
+                }
+            }
+
+            std::size_t CountBefore(std::size_t slot) const
+            {
+                std::size_t count = 0;
+                for (auto i = slot; i > 0; i -= i & (~i + 1))
+                {
+                    count += counts[i];
+                }
+                return count;
+            }
+
+            std::vector<std::size_t> counts;
+        };
+
+        struct Differ
+        {
+            void DiffNode(const Node& old_node, const Node& new_node, std::vector<std::size_t>* path)
+            {
+                if (cache.Get(old_node) == cache.Get(new_node))
+                {
+                    return;
+                }
+
+                if (old_node.name != new_node.name || old_node.value != new_node.value)
+                {
+                    PatchOperation op = {PatchType::SET, *path, new_node.name, new_node.value, 0, 0, nullptr};
+                    patch.emplace_back(std::move(op));
+                }
+
+                DiffChildren(old_node, new_node, path);
+            }
+
+            void DiffChildren(const Node& old_node, const Node& new_node, std::vector<std::size_t>* path)
+            {
+                const auto& old_children = old_node.children;
+                const auto& new_children = new_node.children;
+
+                // match identical children first, then children with the same name in order
+                std::vector<std::size_t> match(new_children.size(), NO_MATCH);
+                std::vector<bool> old_used(old_children.size(), false);
+                {
+                    std::map<Fingerprint, std::deque<std::size_t>, FingerprintLess> identical;
+                    for (std::size_t i = 0; i < old_children.size(); i += 1)
+                    {
+                        identical[cache.Get(*old_children[i])].emplace_back(i);
+                    }
+                    for (std::size_t i = 0; i < new_children.size(); i += 1)
+                    {
+                        auto found = identical.find(cache.Get(*new_children[i]));
+                        if (found != identical.end() && found->second.empty() == false)
+                        {
+                            match[i] = found->second.front();
+                            old_used[match[i]] = true;
+                            found->second.pop_front();
+                        }
+                    }
+                }
+                {
+                    std::map<std::string, std::deque<std::size_t>> by_name;
+                    for (std::size_t i = 0; i < old_children.size(); i += 1)
+                    {
+                        if (old_used[i] == false)
+                        {
+                            by_name[old_children[i]->name].emplace_back(i);
+                        }
+                    }
+                    for (std::size_t i = 0; i < new_children.size(); i += 1)
+                    {
+                        if (match[i] != NO_MATCH)
+                        {
+                            continue;
+                        }
+                        auto found = by_name.find(new_children[i]->name);
+                        if (found != by_name.end() && found->second.empty() == false)
+                        {
+                            match[i] = found->second.front();
+                            old_used[match[i]] = true;
+                            found->second.pop_front();
+                        }
+                    }
+                }
+
+                auto add = [this, path](PatchType type, std::size_t index, std::size_t target, std::shared_ptr<Node> node) {
+                    PatchOperation op = {type, *path, "", "", index, target, node};
+                    patch.emplace_back(std::move(op));
+                };
+
+                // removing from the back keeps the indices of the children before it
+                for (std::size_t i = old_children.size(); i > 0; i -= 1)
+                {
+                    if (old_used[i - 1] == false)
+                    {
+                        add(PatchType::REMOVE, i - 1, 0, nullptr);
+                    }
+                }
+
+                // children in the longest run that is already in order stay, the rest are placed after the child before them.
+                // That builds the new order from the front: a run of placed children follows each child that stays,
+                // and the children that are still to be moved wait in their old order in front of the next child that stays.
+                // Every child gets a slot for where it waits and one for where it ends up, in the order they are in the list.
+                const auto stays = LongestIncreasing(match);
+                std::vector<std::size_t> new_index_of_old(old_children.size(), NO_MATCH);
+                for (std::size_t i = 0; i < new_children.size(); i += 1)
+                {
+                    if (match[i] != NO_MATCH)
+                    {
+                        new_index_of_old[match[i]] = i;
+                    }
+                }
+
+                // the new index of the next child that stays, for every old child that waits to be moved
+                std::vector<std::size_t> waits_before(old_children.size(), NO_MATCH);
+                {
+                    auto next_stay = new_children.size();
+                    for (std::size_t o = old_children.size(); o > 0; o -= 1)
+                    {
+                        const auto i = new_index_of_old[o - 1];
+                        if (i == NO_MATCH)
+                        {
+                            continue;
+                        }
+                        if (stays[i])
+                        {
+                            next_stay = i;
+                        }
+                        else
+                        {
+                            waits_before[o - 1] = next_stay;
+                        }
+                    }
+                }
+
+                std::vector<std::size_t> waiting_count(new_children.size() + 1, 0);
+                for (const auto before : waits_before)
+                {
+                    if (before != NO_MATCH)
+                    {
+                        waiting_count[before] += 1;
+                    }
+                }
+                std::vector<std::size_t> final_slot(new_children.size());
+                std::vector<std::size_t> next_waiting_slot(new_children.size() + 1);
+                {
+                    std::size_t slot = 0;
+                    for (std::size_t i = 0; i <= new_children.size(); i += 1)
+                    {
+                        next_waiting_slot[i] = slot;
+                        slot += waiting_count[i];
+                        if (i < new_children.size())
+                        {
+                            final_slot[i] = slot;
+                            slot += 1;
+                        }
+                    }
+                }
+                std::vector<std::size_t> waiting_slot(old_children.size(), NO_MATCH);
+                for (std::size_t o = 0; o < old_children.size(); o += 1)
+                {
+                    const auto before = waits_before[o];
+                    if (before != NO_MATCH)
+                    {
+                        waiting_slot[o] = next_waiting_slot[before];
+                        next_waiting_slot[before] += 1;
+                    }
+                }
+
+                auto positions = PositionTree{old_children.size() + new_children.size()};
+                for (std::size_t o = 0; o < old_children.size(); o += 1)
+                {
+                    if (waiting_slot[o] != NO_MATCH)
+                    {
+                        positions.Insert(waiting_slot[o]);
+                    }
+                }
+                for (std::size_t i = 0; i < new_children.size(); i += 1)
+                {
+                    if (stays[i])
+                    {
+                        positions.Insert(final_slot[i]);
+                    }
+                }
+
+                for (std::size_t i = 0; i < new_children.size(); i += 1)
+                {
+                    if (stays[i])
+                    {
+                        continue;
+                    }
+                    if (match[i] == NO_MATCH)
+                    {
+                        add(PatchType::INSERT, positions.CountBefore(final_slot[i]), 0, new_children[i]);
+                    }
+                    else
+                    {
+                        const auto from = positions.CountBefore(waiting_slot[match[i]]);
+                        positions.Erase(waiting_slot[match[i]]);
+                        const auto target = positions.CountBefore(final_slot[i]);
+                        if (from != target)
+                        {
+                            add(PatchType::MOVE, from, target, nullptr);
+                        }
+                    }
+                    positions.Insert(final_slot[i]);
+                }
+
+                // the children are now in the new order, patch the ones that changed
+                for (std::size_t i = 0; i < new_children.size(); i += 1)
+                {
+                    if (match[i] != NO_MATCH)
+                    {
+                        path->emplace_back(i);
+                        DiffNode(*old_children[match[i]], *new_children[i], path);
+                        path->pop_back();
+                    }
+                }
+            }
+
+            FingerprintCache cache;
+            Patch patch;
+        };
+
+        Node* FindNode(Node* root, const std::vector<std::size_t>& path)
+        {
+            auto* node = root;
+            for (const auto index : path)
+            {
+                if (index >= node->children.size())
+                {
+                    return nullptr;
+                }
+                node = node->children[index].get();
+            }
+            return node;
+        }
+    }
+
+    Patch Diff(std::shared_ptr<Node> old_root, std::shared_ptr<Node> new_root)
+    {
+        Differ differ;
+        std::vector<std::size_t> path;
+        differ.DiffNode(*old_root, *new_root, &path);
+        return differ.patch;
+    }
+
+    bool Apply(std::shared_ptr<Node> root, const Patch& patch)
+    {
+        for (const auto& op : patch)
+        {
+            auto* node = FindNode(root.get(), op.path);
+            if (node == nullptr)
+            {
+                return false;
+            }
+
+            auto& children = node->children;
+            switch (op.type)
+            {
+            case PatchType::SET:
+                node->name = op.name;
+                node->value = op.value;
+                break;
+            case PatchType::INSERT:
+                if (op.index > children.size() || op.node == nullptr)
+                {
+                    return false;
+                }
+                children.insert(children.begin() + static_cast<std::ptrdiff_t>(op.index), DeepCopy(*op.node));
+                break;
+            case PatchType::REMOVE:
+                if (op.index >= children.size())
+                {
+                    return false;
+                }
+                children.erase(children.begin() + static_cast<std::ptrdiff_t>(op.index));
+                break;
+            case PatchType::MOVE:
+            {
+                if (op.index >= children.size() || op.target >= children.size())
+                {
+                    return false;
+                }
+                auto moved = children[op.index];
+                children.erase(children.begin() + static_cast<std::ptrdiff_t>(op.index));
+                children.insert(children.begin() + static_cast<std::ptrdiff_t>(op.target), moved);
+                break;
+            }
+            }
+        }
+        return true;
+    }
+
+    std::string WritePatch(const Patch& patch)
+    {
+        std::string out;
+        out.append(MAGIC, sizeof(MAGIC));
+        WriteVarint(&out, VERSION);
+        WriteVarint(&out, patch.size());
+        for (const auto& op : patch)
+        {
+            WriteVarint(&out, static_cast<std::size_t>(op.type));
+            WriteVarint(&out, op.path.size());
+            for (const auto index : op.path)
+            {
+                WriteVarint(&out, index);
+            }
+            switch (op.type)
+            {
+            case PatchType::SET:
+                WriteVarintString(&out, op.name);
+                WriteVarintString(&out, op.value);
+                break;
+            case PatchType::INSERT:
+                WriteVarint(&out, op.index);
+                WriteVarintString(&out, WriteBinary(op.node));
+                break;
+            case PatchType::REMOVE:
+                WriteVarint(&out, op.index);
+                break;
+            case PatchType::MOVE:
+                WriteVarint(&out, op.index);
+                WriteVarint(&out, op.target);
+                break;
+            }
+        }
+        return out;
+    }
+
+    bool ReadPatch(const std::string& filename, const std::string& data, Patch* patch, std::vector<std::string>* errors)
+    {
+        auto error = [&](const std::string& message) {
+            errors->emplace_back(fmt::format("{}: {}", filename, message));
+            return false;
+        };
+
+        if (data.size() < sizeof(MAGIC) || std::memcmp(data.data(), MAGIC, sizeof(MAGIC)) != 0)
+        {
+            return error("Not a info patch");
+        }
+
+        auto reader = BinaryReader{data.data(), data.size(), sizeof(MAGIC)};
+        std::size_t version = 0;
+        std::size_t count = 0;
+        if (!reader.ReadVarint(&version) || !reader.ReadVarint(&count))
+        {
+            return error("Patch header is truncated");
+        }
+        if (version != VERSION)
+        {
+            return error(fmt::format("Unsupported patch version {}", version));
+        }
+
+        patch->clear();
+        for (std::size_t i = 0; i < count; i += 1)
+        {
+            PatchOperation op = {PatchType::SET, {}, "", "", 0, 0, nullptr};
+            std::size_t type = 0;
+            std::size_t path_size = 0;
+            if (!reader.ReadVarint(&type) || !reader.ReadVarint(&path_size) || path_size > reader.size - reader.position)
+            {
+                return error("Patch operation is truncated");
+            }
+            for (std::size_t p = 0; p < path_size; p += 1)
+            {
+                std::size_t index = 0;
+                if (reader.ReadVarint(&index) == false)
+                {
+                    return error("Patch operation is truncated");
+                }
+                op.path.emplace_back(index);
+            }
+
+            bool ok = false;
+            switch (type)
+            {
+            case static_cast<std::size_t>(PatchType::SET):
+                op.type = PatchType::SET;
+                ok = reader.ReadString(&op.name) && reader.ReadString(&op.value);
+                break;
+            case static_cast<std::size_t>(PatchType::INSERT):
+            {
+                op.type = PatchType::INSERT;
+                std::string node;
+                ok = reader.ReadVarint(&op.index) && reader.ReadString(&node);
+                if (ok)
+                {
+                    op.node = ReadBinary(filename, node, errors);
+                    ok = op.node != nullptr;
+                }
+                break;
+            }
+            case static_cast<std::size_t>(PatchType::REMOVE):
+                op.type = PatchType::REMOVE;
+                ok = reader.ReadVarint(&op.index);
+                break;
+            case static_cast<std::size_t>(PatchType::MOVE):
+                op.type = PatchType::MOVE;
+                ok = reader.ReadVarint(&op.index) && reader.ReadVarint(&op.target);
+                break;
+            default:
+                return error(fmt::format("Invalid patch operation {}", type));
+            }
+            if (ok == false)
+            {
+                return error("Patch operation is truncated");
+            }
+            patch->emplace_back(std::move(op));
+        }
+
+        if (reader.position != reader.size)
+        {
+            return error("Trailing data after patch");
+        }
+        return true;
+    }
+}
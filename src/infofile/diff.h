@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "infofile/node.h"
+
+namespace infofile
+{
+    enum class PatchType
+    {
+        SET,     // change name and value
+        INSERT,  // insert a new child
+        REMOVE,  // remove a child
+        MOVE     // move a child within the same parent
+    };
+
+    struct PatchOperation
+    {
+        PatchType type;
+
+        /** Child indices from the root to the node the operation applies to.
+        */
+        std::vector<std::size_t> path;
+
+        /** The new name and value for SET.
+        */
+        std::string name;
+        std::string value;
+
+        /** The child to insert at, remove or move.
+        */
+        std::size_t index;
+
+        /** Where a moved child is inserted, counted after it has been removed.
+        */
+        std::size_t target;
+
+        /** The new child for INSERT.
+        */
+        std::shared_ptr<Node> node;
+    };
+
+    /** A list of operations, applied in order.
+    */
+    using Patch = std::vector<PatchOperation>;
+
+    /** Create a small patch that turns the old tree into the new tree.
+    Identical subtrees are skipped by comparing fingerprints, children are matched by fingerprint and then by name,
+    matched children that are out of order are moved and the rest is removed or inserted.
+    */
+    Patch Diff(std::shared_ptr<Node> old_root, std::shared_ptr<Node> new_root);
+
+    /** Apply a patch to a tree, the inserted nodes are copied.
+    Returns false if the patch doesn't fit the tree, the tree may then be partially patched.
+    */
+    bool Apply(std::shared_ptr<Node> root, const Patch& patch);
+
+    std::string WritePatch(const Patch& patch);
+    bool ReadPatch(const std::string& filename, const std::string& data, Patch* patch, std::vector<std::string>* errors);
+}
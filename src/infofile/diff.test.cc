@@ -0,0 +1,108 @@
+#include "catch.hpp"
+#include "catchy/stringeq.h"
+#include "infofile/diff.h"
+#include "infofile/infofile.h"
+
+using namespace infofile;
+
+namespace
+{
+    std::shared_ptr<Node> ParseInline(const std::string& src)
+    {
+        std::vector<std::string> errors;
+        return Parse("inline", src, &errors);
+    }
+
+    std::string Print(std::shared_ptr<Node> root)
+    {
+        return PrintToString(PrintOptions{}, root);
+    }
+
+    std::string Patched(const std::string& old_src, const std::string& new_src, std::size_t* size = nullptr)
+    {
+        auto root = ParseInline(old_src);
+        const auto patch = Diff(root, ParseInline(new_src));
+        if (size != nullptr)
+        {
+            *size = patch.size();
+        }
+        CHECK(Apply(root, patch));
+        return Print(root);
+    }
+}
+
+TEST_CASE("diff", "[diff]")
+{
+    SECTION("same")
+    {
+        std::size_t size = 1;
+        CHECK(catchy::StringEq(Patched("a b { c d }", "a b { c d }", &size), Print(ParseInline("a b { c d }"))));
+        CHECK(0 == size);
+    }
+
+    SECTION("set")
+    {
+        std::size_t size = 0;
+        const auto expected = Print(ParseInline("a b { c e }; f g"));
+        CHECK(catchy::StringEq(Patched("a b { c d }; f g", "a b { c e }; f g", &size), expected));
+        CHECK(1 == size);
+    }
+
+    SECTION("insert and remove")
+    {
+        CHECK(catchy::StringEq(Patched("a b; c d", "x y; a b; z w"), Print(ParseInline("x y; a b; z w"))));
+        CHECK(catchy::StringEq(Patched("a b; c d; e f", "c d"), Print(ParseInline("c d"))));
+        CHECK(catchy::StringEq(Patched("", "a { b { c d } }"), Print(ParseInline("a { b { c d } }"))));
+    }
+
+    SECTION("move")
+    {
+        std::size_t size = 0;
+        CHECK(catchy::StringEq(Patched("a 1; b 2; c 3; d 4", "d 4; a 1; b 2; c 3", &size), Print(ParseInline("d 4; a 1; b 2; c 3"))));
+        CHECK(1 == size);
+        CHECK(catchy::StringEq(Patched("a 1; b 2; c 3; d 4", "d 4; c 3; b 2; a 1"), Print(ParseInline("d 4; c 3; b 2; a 1"))));
+        CHECK(catchy::StringEq(Patched("a 1; b { c 2 }; d 4", "d 5; x y; b { c 3 }; a 1"), Print(ParseInline("d 5; x y; b { c 3 }; a 1"))));
+    }
+
+    SECTION("moves mixed with inserts and waiting children")
+    {
+        // f and e wait in front of c until they are moved, x and y are inserted between moved children
+        const std::string after = "f 6; x 0; a 1; c 3; e 5; y 0; b 2; d 4";
+        CHECK(catchy::StringEq(Patched("a 1; b 2; c 3; d 4; e 5; f 6", after), Print(ParseInline(after))));
+    }
+
+    SECTION("does not fit")
+    {
+        auto root = ParseInline("a b");
+        const auto patch = Diff(ParseInline("a b; c { d e }"), ParseInline("a b; c { d f }"));
+        CHECK_FALSE(Apply(root, patch));
+    }
+}
+
+TEST_CASE("patch file", "[diff]")
+{
+    const auto old_src = "a 1; b { c 2 }; d 4";
+    const auto new_src = "d 5; x { y z }; b { c 3 }; a 1";
+    const auto data = WritePatch(Diff(ParseInline(old_src), ParseInline(new_src)));
+
+    SECTION("round trip")
+    {
+        std::vector<std::string> errors;
+        Patch patch;
+        REQUIRE(ReadPatch("patch", data, &patch, &errors));
+        CHECK(errors.empty());
+        auto root = ParseInline(old_src);
+        CHECK(Apply(root, patch));
+        CHECK(catchy::StringEq(Print(root), Print(ParseInline(new_src))));
+    }
+
+    SECTION("malformed")
+    {
+        std::vector<std::string> errors;
+        Patch patch;
+        CHECK_FALSE(ReadPatch("patch", "INFB", &patch, &errors));
+        CHECK_FALSE(ReadPatch("patch", data.substr(0, data.size() - 1), &patch, &errors));
+        CHECK_FALSE(ReadPatch("patch", data + "x", &patch, &errors));
+        CHECK(3 == errors.size());
+    }
+}
@@ -0,0 +1,614 @@
+#include "infofile/editor.h"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <tuple>
+
+#include "infofile/chars.h"
+#include "infofile/printbuffer.h"
+#include "infofile/printstring.h"
+
+namespace infofile
+{
+    namespace
+    {
+        bool IsBlank(char c)
+        {
+            return c == ' ' || c == '\t' || c == '\r';
+        }
+
+        bool IsSpace(char c)
+        {
+            return IsBlank(c) || c == '\n';
+        }
+
+        std::size_t LineStart(std::string_view source, std::size_t position)
+        {
+            while (position > 0 && source[position - 1] != '\n')
+            {
+                position -= 1;
+            }
+            return position;
+        }
+
+        bool IsBlankBefore(std::string_view source, std::size_t position)
+        {
+            for (auto i = LineStart(source, position); i < position; i += 1)
+            {
+                if (IsBlank(source[i]) == false)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        std::string LineIndent(std::string_view source, std::size_t position)
+        {
+            const auto start = LineStart(source, position);
+            auto end = start;
+            while (end < source.size() && IsBlank(source[end]))
+            {
+                end += 1;
+            }
+            return std::string{source.substr(start, end - start)};
+        }
+
+        std::size_t SkipBlanks(std::string_view source, std::size_t position)
+        {
+            while (position < source.size() && IsBlank(source[position]))
+            {
+                position += 1;
+            }
+            return position;
+        }
+
+        bool IsWordChar(char c)
+        {
+            return IsIdentChar(c, false) || c == '-' || c == '#';
+        }
+
+        /** If the two characters would be lexed as part of the same token, such as two words or two quoted strings.
+        */
+        bool Joins(char before, char after)
+        {
+            const auto words = IsWordChar(before) && IsWordChar(after);
+            const auto quotes = before == after && (before == '"' || before == '\'');
+            return words || quotes;
+        }
+
+        bool IsSeparator(std::string_view source, std::size_t position)
+        {
+            return position < source.size() && (source[position] == ';' || source[position] == ',');
+        }
+
+        std::string PrintChild(PrintOptions po, const Node& node)
+        {
+            po.compact = false;
+            std::string printed;
+            {
+                PrintBuffer buffer{StringSink(&printed)};
+                PrintBuffered(&buffer, po, node);
+            }
+            return printed;
+        }
+
+        /** Prefix every non empty line.
+        */
+        std::string Indent(const std::string& text, const std::string& indent)
+        {
+            std::string ret;
+            std::size_t start = 0;
+            while (start < text.size())
+            {
+                const auto newline = text.find('\n', start);
+                const auto end = newline == std::string::npos ? text.size() : newline + 1;
+                if (text[start] != '\n')
+                {
+                    ret += indent;
+                }
+                ret.append(text, start, end - start);
+                start = end;
+            }
+            return ret;
+        }
+
+        void CollectSubtree(const Node& node, std::unordered_set<const Node*>* nodes)
+        {
+            nodes->insert(&node);
+            for (const auto& c : node.children)
+            {
+                CollectSubtree(*c, nodes);
+            }
+        }
+
+        bool IsBefore(const SourceEdit& lhs, const SourceEdit& rhs)
+        {
+            return std::make_tuple(lhs.begin, lhs.end, lhs.kind) < std::make_tuple(rhs.begin, rhs.end, rhs.kind);
+        }
+    }
+
+    SourceEditor::SourceEditor(std::string_view s, const SourceSpans* sp, const PrintOptions& po)
+        : source(s)
+        , spans(sp)
+        , options(po)
+    {
+    }
+
+    bool SourceEditor::SetValue(const Node& node, const std::string& value)
+    {
+        const auto s = spans->Find(node);
+        if (s.has_value() == false || &node == spans->root || IsRemoved(node))
+        {
+            return false;
+        }
+
+        std::string text;
+        PrintString(&text, value);
+        if (s->value.IsEmpty() == false)
+        {
+            return AddEdit(&node, s->value.begin, s->value.end, EditKind::REPLACE, text);
+        }
+        if (s->name.IsEmpty())
+        {
+            return false;
+        }
+        return AddEdit(&node, s->name.end, s->name.end, EditKind::VALUE, " " + text);
+    }
+
+    bool SourceEditor::SetName(const Node& node, const std::string& name)
+    {
+        const auto s = spans->Find(node);
+        if (s.has_value() == false || s->name.IsEmpty() || IsRemoved(node))
+        {
+            return false;
+        }
+        return AddEdit(&node, s->name.begin, s->name.end, EditKind::REPLACE, PrintString(name));
+    }
+
+    bool SourceEditor::Remove(const Node& node)
+    {
+        const auto s = spans->Find(node);
+        if (s.has_value() == false || &node == spans->root)
+        {
+            return false;
+        }
+
+        auto begin = s->node.begin;
+        auto end = s->node.end;
+        auto after = SkipBlanks(source, end);
+        if (IsSeparator(source, after))
+        {
+            end = after + 1;
+            after = SkipBlanks(source, end);
+        }
+        if (IsBlankBefore(source, begin) && (after == source.size() || source[after] == '\n'))
+        {
+            begin = LineStart(source, begin);
+            end = after == source.size() ? after : after + 1;
+        }
+        else if (after < source.size() && source[after] != '\n')
+        {
+            end = after;
+        }
+
+        std::unordered_set<const Node*> subtree;
+        CollectSubtree(node, &subtree);
+        for (const auto& e : edits)
+        {
+            if (subtree.count(e.owner) != 0)
+            {
+                continue;
+            }
+            const auto touches_node = s->node.begin < e.begin && e.begin <= s->node.end;
+            const auto overlaps = e.begin < end && begin < e.end;
+            if (touches_node || overlaps)
+            {
+                return false;
+            }
+        }
+
+        const auto owned = [&subtree](const SourceEdit& e) { return subtree.count(e.owner) != 0; };
+        edits.erase(std::remove_if(edits.begin(), edits.end(), owned), edits.end());
+        if (AddEdit(&node, begin, end, EditKind::REPLACE, "") == false || KeepApart(node) == false)
+        {
+            return false;
+        }
+        removed.insert(&node);
+
+        // the removed children of the node are covered by it now
+        auto inside = removed_spans.lower_bound(s->node.begin);
+        while (inside != removed_spans.end() && inside->second <= s->node.end)
+        {
+            inside = removed_spans.erase(inside);
+        }
+        removed_spans[s->node.begin] = s->node.end;
+        return true;
+    }
+
+    bool SourceEditor::AddChild(const Node& parent, const Node& child)
+    {
+        const auto s = spans->Find(parent);
+        if (s.has_value() == false || IsRemoved(parent))
+        {
+            return false;
+        }
+
+        if (s->body.IsEmpty() == false && source[s->body.begin] == '[')
+        {
+            if (child.name.empty() == false || child.children.empty() == false)
+            {
+                return false;
+            }
+
+            auto text = PrintString(child.value);
+            const auto* last = LastChild(parent);
+            if (last == nullptr)
+            {
+                return AddEdit(&parent, s->body.begin + 1, s->body.begin + 1, EditKind::CHILD, HasEdit(s->body.begin + 1, EditKind::CHILD) ? ", " + text : text);
+            }
+
+            const auto last_end = spans->Find(*last)->node.end;
+            const auto after = SkipBlanks(source, last_end);
+            if (IsSeparator(source, after))
+            {
+                return AddEdit(&parent, after + 1, after + 1, EditKind::CHILD, HasEdit(after + 1, EditKind::CHILD) ? ", " + text : " " + text);
+            }
+            return AddEdit(&parent, last_end, last_end, EditKind::CHILD, ", " + text);
+        }
+
+        if (s->body.IsEmpty() == false)
+        {
+            const auto close = s->body.end - 1;
+            if (source[close] != '}' || SeparateLastChild(parent) == false)
+            {
+                return false;
+            }
+
+            if (IsBlankBefore(source, close))
+            {
+                const auto start = LineStart(source, close);
+                const auto indent = std::string{source.substr(start, close - start)} + options.tab;
+                return AddEdit(&parent, start, start, EditKind::CHILD, Indent(PrintChild(options, child), indent));
+            }
+
+            auto po = options;
+            po.tab = "";
+            po.newline = " ";
+            auto text = PrintChild(po, child);
+            if (close > 0 && IsSpace(source[close - 1]) == false)
+            {
+                text = " " + text;
+            }
+            return AddEdit(&parent, close, close, EditKind::CHILD, text);
+        }
+
+        if (&parent == spans->root)
+        {
+            if (SeparateLastChild(parent) == false)
+            {
+                return false;
+            }
+            auto text = PrintChild(options, child);
+            if (source.empty() == false && source.back() != '\n' && HasEdit(source.size(), EditKind::CHILD) == false)
+            {
+                text = options.newline + text;
+            }
+            return AddEdit(&parent, source.size(), source.size(), EditKind::CHILD, text);
+        }
+
+        // a leaf that gets it's first children, array values can't have any
+        if (s->name.IsEmpty())
+        {
+            return false;
+        }
+
+        const auto indent = LineIndent(source, s->node.begin);
+        const auto printed = Indent(PrintChild(options, child), indent + options.tab);
+        const auto closing = indent + "}";
+        for (auto& e : edits)
+        {
+            if (e.owner == &parent && e.begin == s->node.end && e.end == s->node.end && e.kind == EditKind::BODY)
+            {
+                e.text.insert(e.text.size() - closing.size(), printed);
+                return true;
+            }
+        }
+        return AddEdit(&parent, s->node.end, s->node.end, EditKind::BODY, " {" + options.newline + printed + closing);
+    }
+
+    void SourceEditor::Write(PrintBuffer* buffer) const
+    {
+        // where a edit meets other text a space keeps two tokens from becoming one
+        char last = 0;
+        const auto write = [buffer, &last](std::string_view text) {
+            if (text.empty())
+            {
+                return;
+            }
+            if (Joins(last, text.front()))
+            {
+                buffer->Write(' ');
+            }
+            if (text.size() >= buffer->block_size)
+            {
+                buffer->WriteBlock(text);
+            }
+            else
+            {
+                buffer->Write(text);
+            }
+            last = text.back();
+        };
+
+        std::size_t position = 0;
+        for (const auto& e : edits)
+        {
+            write(source.substr(position, e.begin - position));
+            write(e.text);
+            position = e.end;
+        }
+        write(source.substr(position));
+    }
+
+    std::string SourceEditor::ToString() const
+    {
+        std::string ret;
+        {
+            PrintBuffer buffer{StringSink(&ret)};
+            Write(&buffer);
+        }
+        return ret;
+    }
+
+    bool SourceEditor::AddEdit(const Node* owner, std::size_t begin, std::size_t end, EditKind kind, const std::string& text)
+    {
+        if (begin > end || end > source.size())
+        {
+            return false;
+        }
+
+        std::vector<std::size_t> contained;
+        for (std::size_t i = 0; i < edits.size(); i += 1)
+        {
+            auto& e = edits[i];
+            if (begin == end)
+            {
+                if (e.begin < begin && begin < e.end)
+                {
+                    return false;
+                }
+                if (e.begin == begin && e.end == end && e.kind == kind)
+                {
+                    if (kind == EditKind::CHILD)
+                    {
+                        e.text += text;
+                    }
+                    else
+                    {
+                        e.text = text;
+                    }
+                    return true;
+                }
+            }
+            else
+            {
+                const auto inside = begin <= e.begin && e.end <= end;
+                const auto at_edge = e.begin == e.end && (e.begin == begin || e.begin == end);
+                if (inside && at_edge == false)
+                {
+                    // only a new text for the same node may replace a edit, never a removal or a insert
+                    if (e.owner != owner || e.kind != kind || removed.count(e.owner) != 0)
+                    {
+                        return false;
+                    }
+                    contained.emplace_back(i);
+                }
+                else if (e.begin < end && begin < e.end)
+                {
+                    return false;
+                }
+            }
+        }
+
+        for (auto i = contained.size(); i > 0; i -= 1)
+        {
+            edits.erase(edits.begin() + static_cast<std::ptrdiff_t>(contained[i - 1]));
+        }
+
+        auto edit = SourceEdit{owner, begin, end, kind, text};
+        edits.insert(std::upper_bound(edits.begin(), edits.end(), edit, IsBefore), edit);
+        return true;
+    }
+
+    bool SourceEditor::HasEdit(std::size_t position, EditKind kind) const
+    {
+        for (const auto& e : edits)
+        {
+            if (e.begin == position && e.end == position && e.kind == kind)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool SourceEditor::IsRemoved(const Node& node) const
+    {
+        if (removed.count(&node) != 0)
+        {
+            return true;
+        }
+        // a root without braces can have the same span as it's only child, other nodes are larger than their children
+        const auto s = spans->Find(node);
+        if (s.has_value() == false || &node == spans->root)
+        {
+            return false;
+        }
+        const auto after = removed_spans.upper_bound(s->node.begin);
+        return after != removed_spans.begin() && s->node.end <= std::prev(after)->second;
+    }
+
+    std::size_t SourceEditor::ChildrenStartingBefore(const Node& parent, std::size_t position) const
+    {
+        const auto starts_after = [this](std::size_t p, const std::shared_ptr<Node>& child) {
+            const auto cs = spans->Find(*child);
+            return p < (cs.has_value() ? cs->node.begin : std::numeric_limits<std::size_t>::max());
+        };
+        const auto after = std::upper_bound(parent.children.begin(), parent.children.end(), position, starts_after);
+        return static_cast<std::size_t>(after - parent.children.begin());
+    }
+
+    std::size_t SourceEditor::ChildIndex(const Node& parent, const Node& child) const
+    {
+        const auto s = spans->Find(child);
+        if (s.has_value() == false)
+        {
+            return parent.children.size();
+        }
+
+        // nodes without any text, like a lone separator, may start at the same position as the child
+        for (auto i = ChildrenStartingBefore(parent, s->node.begin); i > 0; i -= 1)
+        {
+            const auto* c = parent.children[i - 1].get();
+            if (c == &child)
+            {
+                return i - 1;
+            }
+            const auto cs = spans->Find(*c);
+            if (cs.has_value() == false || cs->node.begin != s->node.begin)
+            {
+                break;
+            }
+        }
+        return parent.children.size();
+    }
+
+    const Node* SourceEditor::LastChild(const Node& parent) const
+    {
+        for (auto i = parent.children.size(); i > 0; i -= 1)
+        {
+            const auto* child = parent.children[i - 1].get();
+            if (removed.count(child) == 0 && spans->Find(*child).has_value())
+            {
+                return child;
+            }
+        }
+        return nullptr;
+    }
+
+    bool SourceEditor::SeparateLastChild(const Node& parent)
+    {
+        const auto* last = LastChild(parent);
+        if (last == nullptr)
+        {
+            return true;
+        }
+
+        const auto s = spans->Find(*last);
+        if (s->body.IsEmpty() == false || s->value.IsEmpty() == false || s->name.IsEmpty())
+        {
+            return true;
+        }
+        return Separate(*last);
+    }
+
+    bool SourceEditor::Separate(const Node& node)
+    {
+        const auto s = spans->Find(node);
+        if (HasEdit(s->node.end, EditKind::BODY) || HasEdit(s->node.end, EditKind::SEPARATOR))
+        {
+            return true;
+        }
+
+        auto after = s->node.end;
+        while (after < source.size() && IsSpace(source[after]))
+        {
+            after += 1;
+        }
+        if (IsSeparator(source, after))
+        {
+            return true;
+        }
+        return AddEdit(&node, s->node.end, s->node.end, EditKind::SEPARATOR, options.term.empty() ? ";" : options.term);
+    }
+
+    const Node* SourceEditor::FindParent(const Node& node) const
+    {
+        const auto s = spans->Find(node);
+        if (s.has_value() == false)
+        {
+            return nullptr;
+        }
+
+        // the children are in source order, so each level is a binary search for the child that contains the node
+        const Node* parent = spans->root;
+        while (parent != nullptr)
+        {
+            if (ChildIndex(*parent, node) != parent->children.size())
+            {
+                return parent;
+            }
+            const auto before = ChildrenStartingBefore(*parent, s->node.begin);
+            if (before == 0)
+            {
+                return nullptr;
+            }
+            const auto* candidate = parent->children[before - 1].get();
+            const auto cs = spans->Find(*candidate);
+            const auto contains = cs->body.IsEmpty() == false && cs->body.begin <= s->node.begin && s->node.end <= cs->body.end;
+            parent = contains ? candidate : nullptr;
+        }
+        return nullptr;
+    }
+
+    bool SourceEditor::KeepApart(const Node& removed_node)
+    {
+        const auto* parent = FindParent(removed_node);
+        if (parent == nullptr)
+        {
+            return true;
+        }
+        const auto ps = spans->Find(*parent);
+        if (ps->body.IsEmpty() == false && source[ps->body.begin] == '[')
+        {
+            return true;
+        }
+
+        const auto& children = parent->children;
+        const auto index = ChildIndex(*parent, removed_node);
+        const auto kept = [this](const Node* c) { return removed.count(c) == 0 && spans->Find(*c).has_value(); };
+        const Node* before = nullptr;
+        const Node* after = nullptr;
+        for (auto i = index; i > 0 && before == nullptr; i -= 1)
+        {
+            before = kept(children[i - 1].get()) ? children[i - 1].get() : nullptr;
+        }
+        for (auto i = index + 1; i < children.size() && after == nullptr; i += 1)
+        {
+            after = kept(children[i].get()) ? children[i].get() : nullptr;
+        }
+
+        const auto as = after == nullptr ? std::nullopt : spans->Find(*after);
+        if (as.has_value() == false || as->name.IsEmpty() == false)
+        {
+            return true;
+        }
+
+        if (before == nullptr)
+        {
+            if (parent != spans->root || ps->body.IsEmpty() == false)
+            {
+                return true;
+            }
+            return AddEdit(after, as->node.begin, as->node.begin, EditKind::NAME, "\"\" ");
+        }
+
+        if (spans->Find(*before)->body.IsEmpty() == false)
+        {
+            return true;
+        }
+        return Separate(*before);
+    }
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "infofile/infofile.h"
+#include "infofile/spans.h"
+
+namespace infofile
+{
+    struct PrintBuffer;
+
+    /** Inserts at the same position are written in this order.
+    */
+    enum class EditKind
+    {
+        REPLACE,  // replaces the text between begin and end
+        NAME,  // inserts a empty name before a node that has none
+        VALUE,  // inserts a value after a name, a later value replaces it
+        BODY,  // inserts the {...} of a node that had no children
+        SEPARATOR,  // ends a node that is only a name so a following child doesn't become it's value
+        CHILD  // inserts children into a existing body, later children are appended
+    };
+
+    struct SourceEdit
+    {
+        /** The node the edit was made for, removing a node drops the edits of it and it's children.
+        */
+        const Node* owner;
+        std::size_t begin;
+        std::size_t end;
+        EditKind kind;
+        std::string text;
+    };
+
+    /** Changes a parsed source in place, so comments, whitespace and quoting outside the changed nodes are kept.
+    Edits refer to nodes of the tree that was parsed with the spans, the tree itself isn't changed.
+    The source and spans must outlive the editor.
+    Every function returns false if the edit can't be made, either because the node isn't part of the parsed tree
+    or because the edit overlaps a earlier edit, such as changing a child of a removed node.
+    */
+    struct SourceEditor
+    {
+        SourceEditor(std::string_view s, const SourceSpans* sp, const PrintOptions& po = PrintOptions());
+
+        /** Nodes without a name, such as array values, can only get a new value if they already have one.
+        */
+        bool SetValue(const Node& node, const std::string& value);
+
+        /** The node must already have a name.
+        */
+        bool SetName(const Node& node, const std::string& name);
+
+        /** Removes the node and it's separator, and the line if the node was alone on it.
+        Fails if a edit of another node depends on it, such as a value appended to a array after it.
+        */
+        bool Remove(const Node& node);
+
+        /** Adds a child last, indented like the surrounding lines. Children of arrays must be unnamed values.
+        */
+        bool AddChild(const Node& parent, const Node& child);
+
+        /** Copies the unchanged text straight from the source, so the work besides copying depends only on the edits.
+        */
+        void Write(PrintBuffer* buffer) const;
+        std::string ToString() const;
+
+        bool AddEdit(const Node* owner, std::size_t begin, std::size_t end, EditKind kind, const std::string& text);
+        bool HasEdit(std::size_t position, EditKind kind) const;
+
+        /** Make sure the last child that is kept has a separator if it's only a name, so a appended child doesn't become it's value.
+        */
+        bool SeparateLastChild(const Node& parent);
+        bool Separate(const Node& node);
+        const Node* LastChild(const Node& parent) const;
+
+        /** The node that directly contains the given node, found by it's position.
+        */
+        const Node* FindParent(const Node& node) const;
+
+        /** True if the node or one of it's parents was removed.
+        */
+        bool IsRemoved(const Node& node) const;
+
+        /** The number of children that start at or before the position, found by binary search.
+        */
+        std::size_t ChildrenStartingBefore(const Node& parent, std::size_t position) const;
+
+        /** The index of a child, or the child count if it isn't a child of the parent.
+        */
+        std::size_t ChildIndex(const Node& parent, const Node& child) const;
+
+        /** A node without a name after a removed node would become the body of the node before it,
+        or when it's first in a root without braces the root would be parsed as it.
+        */
+        bool KeepApart(const Node& removed_node);
+
+        std::string_view source;
+        const SourceSpans* spans;
+        PrintOptions options;
+
+        /** Sorted by position and never overlapping.
+        */
+        std::vector<SourceEdit> edits;
+        std::unordered_set<const Node*> removed;
+
+        /** The spans of the removed nodes, begin to end, never nested so a node is removed if the span before it contains it.
+        */
+        std::map<std::size_t, std::size_t> removed_spans;
+    };
+}
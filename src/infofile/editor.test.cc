@@ -0,0 +1,175 @@
+#include <chrono>
+
+#include "catch.hpp"
+#include "catchy/stringeq.h"
+#include "infofile/editor.h"
+#include "infofile/printbuffer.h"
+
+using namespace infofile;
+
+namespace
+{
+    struct Parsed
+    {
+        std::string source;
+        SourceSpans spans;
+        std::shared_ptr<Node> root;
+
+        explicit Parsed(const std::string& src)
+            : source(src)
+        {
+            std::vector<std::string> errors;
+            root = ParseWithSpans("inline", source, &errors, &spans);
+            CHECK(errors.empty());
+        }
+
+        const Node& Get(std::size_t i) const
+        {
+            return *root->children[i];
+        }
+    };
+
+    /** The edited text must parse to the same tree as the expected text.
+    */
+    void CheckParses(const std::string& edited, const std::string& expected)
+    {
+        std::vector<std::string> errors;
+        const auto lhs = PrintToString(PrintOptions{}, Parse("edited", edited, &errors));
+        const auto rhs = PrintToString(PrintOptions{}, Parse("expected", expected, &errors));
+        CHECK(errors.empty());
+        CHECK(catchy::StringEq(lhs, rhs));
+    }
+}
+
+TEST_CASE("editor", "[editor]")
+{
+    SECTION("values and names keep the rest of the text")
+    {
+        const auto p = Parsed{"// head\na 1; // one\nb 2\nc\n"};
+        auto editor = SourceEditor{p.source, &p.spans};
+        CHECK(editor.SetValue(p.Get(0), "hello world"));
+        CHECK(editor.SetName(p.Get(1), "bee"));
+        CHECK(editor.SetValue(p.Get(2), "3"));
+        CHECK(editor.SetValue(p.Get(2), "4"));
+        CHECK(catchy::StringEq(editor.ToString(), "// head\na \"hello world\"; // one\nbee 2\nc \"4\"\n"));
+    }
+
+    SECTION("remove")
+    {
+        const auto p = Parsed{"a 1;\n  b 2; // two\nc { d; e [1, 2, 3] }\n"};
+        auto editor = SourceEditor{p.source, &p.spans};
+        CHECK(editor.Remove(p.Get(0)));
+        CHECK(editor.Remove(p.Get(1)));
+        CHECK(editor.Remove(*p.Get(2).children[0]));
+        CHECK(editor.Remove(*p.Get(2).children[1]->children[1]));
+        CHECK(catchy::StringEq(editor.ToString(), "  // two\nc { e [1, 3] }\n"));
+        CHECK(editor.Remove(*p.root) == false);
+    }
+
+    SECTION("edits inside a removed node fail")
+    {
+        const auto p = Parsed{"a { b c }\nd e"};
+        auto editor = SourceEditor{p.source, &p.spans};
+        CHECK(editor.SetValue(*p.Get(0).children[0], "x"));
+        CHECK(editor.Remove(p.Get(0)));
+        CHECK(editor.SetValue(*p.Get(0).children[0], "y") == false);
+        CHECK(editor.AddChild(p.Get(0), Node{"f", "g"}) == false);
+        CHECK(catchy::StringEq(editor.ToString(), "d e"));
+    }
+
+    SECTION("removed nodes stay removed")
+    {
+        const auto p = Parsed{"x [1, 2]\n1 #f0f\n"};
+        auto editor = SourceEditor{p.source, &p.spans};
+        CHECK(editor.Remove(*p.Get(0).children[1]));
+        CHECK(editor.SetValue(*p.Get(0).children[1], "9") == false);
+        CHECK(editor.Remove(p.Get(1)));
+        CHECK(editor.SetName(p.Get(1), "2") == false);
+        CHECK(editor.SetValue(p.Get(1), "3") == false);
+        CHECK(editor.AddChild(p.Get(1), Node{"", "4"}) == false);
+        CheckParses(editor.ToString(), "x [1]");
+    }
+
+    SECTION("add children")
+    {
+        const auto p = Parsed{"a {\n  b\n}\nc { d e }\nf g; h [1]\n"};
+        auto editor = SourceEditor{p.source, &p.spans};
+        CHECK(editor.AddChild(p.Get(0), Node{"x", "1"}));
+        CHECK(editor.AddChild(p.Get(1), Node{"y", "2"}));
+        CHECK(editor.AddChild(p.Get(2), Node{"z", "3"}));
+        CHECK(editor.AddChild(p.Get(2), Node{"w", "4"}));
+        CHECK(editor.AddChild(p.Get(3), Node{"", "5"}));
+        CHECK(editor.AddChild(p.Get(3), Node{"named", "5"}) == false);
+        CHECK(editor.AddChild(*p.root, Node{"i", "j"}));
+        const auto edited = editor.ToString();
+        CHECK(catchy::StringEq(edited, "a {\n  b;\n  x \"1\";\n}\nc { d e y \"2\"; }\nf g {\n  z \"3\";\n  w \"4\";\n}; h [1, \"5\"]\ni j;\n"));
+        CheckParses(edited, "a { b; x 1 } c { d e; y 2 } f g { z 3; w 4 } h [1, 5] i j");
+    }
+
+    SECTION("write streams the source")
+    {
+        std::string source;
+        for (int i = 0; i < 1000; i += 1)
+        {
+            source += "key value; // comment\n";
+        }
+        const auto p = Parsed{source};
+        auto editor = SourceEditor{p.source, &p.spans};
+        CHECK(editor.SetValue(p.Get(500), "changed"));
+
+        std::string written;
+        std::size_t writes = 0;
+        {
+            PrintBuffer buffer{[&](std::string_view text) {
+                written += text;
+                writes += 1;
+                return true;
+            }, 256};
+            editor.Write(&buffer);
+        }
+        CHECK(writes < 10);
+        CHECK(written.size() == source.size() + 2);
+        CHECK(catchy::StringEq(written, editor.ToString()));
+    }
+}
+
+namespace
+{
+    /** Seconds for editing the last children of a flat file, the fastest of a few runs.
+    */
+    double EditSeconds(std::size_t node_count)
+    {
+        std::string source;
+        for (std::size_t i = 0; i < node_count; i += 1)
+        {
+            source += "key value\n";
+        }
+        const auto p = Parsed{source};
+
+        auto fastest = std::chrono::duration<double>::max();
+        for (int run = 0; run < 3; run += 1)
+        {
+            auto editor = SourceEditor{p.source, &p.spans};
+            const auto start = std::chrono::steady_clock::now();
+            for (std::size_t i = 1; i <= 50; i += 1)
+            {
+                CHECK(editor.SetValue(p.Get(node_count - i), "changed"));
+            }
+            for (std::size_t i = 51; i <= 60; i += 1)
+            {
+                CHECK(editor.Remove(p.Get(node_count - i)));
+            }
+            CHECK(editor.AddChild(*p.root, Node{"added", "1"}));
+            fastest = std::min(fastest, std::chrono::duration<double>(std::chrono::steady_clock::now() - start));
+        }
+        return fastest.count();
+    }
+}
+
+TEST_CASE("editor cost depends on the edits", "[editor]")
+{
+    // a file 100 times larger may only be a little slower to edit, the margin is for noisy machines
+    const auto small = EditSeconds(1000);
+    const auto large = EditSeconds(100000);
+    CHECK(large < small * 10 + 0.005);
+}
@@ -8,6 +8,7 @@ namespace infofile
         : filename(fn)
         , line(0)
         , offset(0)
+        , position(0)
     {
     }
 
@@ -46,6 +47,11 @@ namespace infofile
 
     char File::Count(char c)
     {
+        // 0 is the end of the input, counting it would put spans past the end of the source
+        if (c != 0)
+        {
+            position += 1;
+        }
         if (c == '\n')
         {
             offset = 0;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <optional>
 #include <string>
 
@@ -21,6 +22,10 @@ namespace infofile
         std::string filename;
         int line;
         int offset;
+
+        /** Number of characters read so far, readers keep their own index into their data.
+        */
+        std::size_t position;
         std::optional<char> next;
     };
 }
\ No newline at end of file
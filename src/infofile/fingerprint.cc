@@ -0,0 +1,86 @@
+#include "infofile/fingerprint.h"
+
+#include <map>
+
+#include "infofile/hash.h"
+
+namespace infofile
+{
+    namespace
+    {
+        // two independent hashes make up the 128 bits
+        constexpr std::uint64_t LOW_SEED = 0x243F6A8885A308D3ull;
+        constexpr std::uint64_t HIGH_SEED = 0x13198A2E03707344ull;
+
+        template <typename ChildFingerprint>
+        Fingerprint Combine(const Node& node, ChildFingerprint child_fingerprint)
+        {
+            auto low = HashCombine(Hash64(node.name.data(), node.name.size(), LOW_SEED), Hash64(node.value.data(), node.value.size(), LOW_SEED));
+            auto high = HashCombine(Hash64(node.name.data(), node.name.size(), HIGH_SEED), Hash64(node.value.data(), node.value.size(), HIGH_SEED));
+            low = HashCombine(low, node.children.size());
+            high = HashCombine(high, node.children.size());
+            for (const auto& child : node.children)
+            {
+                const auto fingerprint = child_fingerprint(*child);
+                low = HashCombine(low, fingerprint.low);
+                high = HashCombine(high, fingerprint.high);
+            }
+            return {low, high};
+        }
+    }
+
+    bool Fingerprint::operator==(const Fingerprint& rhs) const
+    {
+        return low == rhs.low && high == rhs.high;
+    }
+
+    bool Fingerprint::operator!=(const Fingerprint& rhs) const
+    {
+        return !(*this == rhs);
+    }
+
+    Fingerprint CalculateFingerprint(const Node& node)
+    {
+        return Combine(node, [](const Node& child) { return CalculateFingerprint(child); });
+    }
+
+    const Fingerprint& FingerprintCache::Get(const Node& node)
+    {
+        auto found = fingerprints.find(&node);
+        if (found != fingerprints.end())
+        {
+            return found->second;
+        }
+        const auto fingerprint = Combine(node, [this](const Node& child) { return Get(child); });
+        return fingerprints.emplace(&node, fingerprint).first->second;
+    }
+
+    std::vector<std::string> ChangedKeys(const Node& old_node, const Node& new_node, FingerprintCache* cache)
+    {
+        std::vector<std::string> changed;
+        if (cache->Get(old_node) == cache->Get(new_node))
+        {
+            return changed;
+        }
+
+        // group the children by name, keeping the order within each name
+        std::map<std::string, std::pair<std::vector<Fingerprint>, std::vector<Fingerprint>>> by_name;
+        for (const auto& child : old_node.children)
+        {
+            by_name[child->name].first.emplace_back(cache->Get(*child));
+        }
+        for (const auto& child : new_node.children)
+        {
+            by_name[child->name].second.emplace_back(cache->Get(*child));
+        }
+
+        for (const auto& [name, fingerprints] : by_name)
+        {
+            if (fingerprints.first != fingerprints.second)
+            {
+                changed.emplace_back(name);
+            }
+        }
+        return changed;
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "infofile/node.h"
+
+namespace infofile
+{
+    /** A 128 bit structural hash of a node, covering the name, the value and the fingerprints of the children in order.
+    Two subtrees with the same fingerprint are equal for all practical purposes.
+    */
+    struct Fingerprint
+    {
+        std::uint64_t low;
+        std::uint64_t high;
+
+        bool operator==(const Fingerprint& rhs) const;
+        bool operator!=(const Fingerprint& rhs) const;
+    };
+
+    Fingerprint CalculateFingerprint(const Node& node);
+
+    /** Remembers the fingerprints of all nodes in a tree so comparing subtrees is a single compare.
+    The nodes must not be changed or destroyed while the cache is in use.
+    */
+    struct FingerprintCache
+    {
+        const Fingerprint& Get(const Node& node);
+
+        std::unordered_map<const Node*, Fingerprint> fingerprints;
+    };
+
+    /** The names of the children that differ between two nodes, added, removed or changed.
+    Children with the same name are compared in order.
+    */
+    std::vector<std::string> ChangedKeys(const Node& old_node, const Node& new_node, FingerprintCache* cache);
+}
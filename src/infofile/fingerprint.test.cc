@@ -0,0 +1,62 @@
+#include "catch.hpp"
+#include "catchy/stringeq.h"
+#include "infofile/fingerprint.h"
+#include "infofile/infofile.h"
+
+using namespace infofile;
+
+namespace
+{
+    Fingerprint FingerprintOf(const std::string& src)
+    {
+        std::vector<std::string> errors;
+        return CalculateFingerprint(*Parse("inline", src, &errors));
+    }
+
+    std::vector<std::string> Changed(const std::string& old_src, const std::string& new_src)
+    {
+        std::vector<std::string> errors;
+        const auto old_root = Parse("old", old_src, &errors);
+        const auto new_root = Parse("new", new_src, &errors);
+        FingerprintCache cache;
+        return ChangedKeys(*old_root, *new_root, &cache);
+    }
+}
+
+TEST_CASE("fingerprint", "[fingerprint]")
+{
+    SECTION("same tree")
+    {
+        CHECK(FingerprintOf("a b { c d }") == FingerprintOf("a = b { c : d; }"));
+    }
+
+    SECTION("differs")
+    {
+        CHECK(FingerprintOf("a b") != FingerprintOf("a c"));
+        CHECK(FingerprintOf("a b") != FingerprintOf("b a"));
+        CHECK(FingerprintOf("a b; c d") != FingerprintOf("c d; a b"));
+        CHECK(FingerprintOf("a { b c }") != FingerprintOf("a b c"));
+        CHECK(FingerprintOf("\"ab\" c") != FingerprintOf("a \"bc\""));
+        CHECK(FingerprintOf("a {}") != FingerprintOf("a { \"\" \"\" }"));
+    }
+
+    SECTION("cache")
+    {
+        std::vector<std::string> errors;
+        const auto root = Parse("inline", "a b { c d } e f", &errors);
+        FingerprintCache cache;
+        CHECK(cache.Get(*root) == CalculateFingerprint(*root));
+        CHECK(cache.Get(*root->children[0]) == CalculateFingerprint(*root->children[0]));
+        CHECK(4 == cache.fingerprints.size());
+    }
+}
+
+TEST_CASE("changed keys", "[fingerprint]")
+{
+    CHECK(Changed("a b; c d", "a b; c d").empty());
+    CHECK(Changed("a b; c { d e }", "a b; c { d f }") == std::vector<std::string>{"c"});
+    CHECK(Changed("a b; c d", "a b") == std::vector<std::string>{"c"});
+    CHECK(Changed("a b", "x y; a b") == std::vector<std::string>{"x"});
+    CHECK(Changed("a 1; a 2; b 3", "a 2; a 1; b 3") == std::vector<std::string>{"a"});
+    CHECK(Changed("a 1; b 2", "b 2; a 1").empty());
+}
@@ -0,0 +1,65 @@
+#include "infofile/hash.h"
+
+namespace infofile
+{
+    namespace
+    {
+        constexpr std::uint64_t PRIME1 = 0x9E3779B97F4A7C15ull;
+        constexpr std::uint64_t PRIME2 = 0xFF51AFD7ED558CCDull;
+        constexpr std::uint64_t PRIME3 = 0xC4CEB9FE1A85EC53ull;
+
+        std::uint64_t RotateLeft(std::uint64_t x, int bits)
+        {
+            return (x << bits) | (x >> (64 - bits));
+        }
+
+        // little endian no matter the platform, compilers turn this into a single load
+        std::uint64_t Load64(const char* data)
+        {
+            const auto* b = reinterpret_cast<const unsigned char*>(data);
+            std::uint64_t r = 0;
+            for (int i = 7; i >= 0; i -= 1)
+            {
+                r = (r << 8) | b[i];
+            }
+            return r;
+        }
+
+        std::uint64_t Avalanche(std::uint64_t h)
+        {
+            h ^= h >> 33;
+            h *= PRIME2;
+            h ^= h >> 33;
+            h *= PRIME3;
+            h ^= h >> 33;
+            return h;
+        }
+    }
+
+    std::uint64_t Hash64(const char* data, std::size_t size, std::uint64_t seed)
+    {
+        auto h = seed ^ (size * PRIME1);
+
+        std::size_t i = 0;
+        for (; i + 8 <= size; i += 8)
+        {
+            auto k = Load64(data + i) * PRIME2;
+            k = RotateLeft(k, 31) * PRIME1;
+            h = RotateLeft(h ^ k, 27) * PRIME1 + PRIME3;
+        }
+
+        std::uint64_t tail = 0;
+        for (std::size_t t = size; t > i; t -= 1)
+        {
+            tail = (tail << 8) | static_cast<unsigned char>(data[t - 1]);
+        }
+        h ^= RotateLeft(tail * PRIME3, 31) * PRIME1;
+
+        return Avalanche(h);
+    }
+
+    std::uint64_t HashCombine(std::uint64_t hash, std::uint64_t value)
+    {
+        return Avalanche(RotateLeft(hash, 23) ^ (value * PRIME1 + PRIME3));
+    }
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace infofile
+{
+    /** A fast non cryptographic 64 bit hash, same result on all platforms.
+    */
+    std::uint64_t Hash64(const char* data, std::size_t size, std::uint64_t seed = 0);
+
+    /** Mix a value into a hash, the order matters.
+    */
+    std::uint64_t HashCombine(std::uint64_t hash, std::uint64_t value);
+}
@@ -0,0 +1,135 @@
+#include "infofile/incremental.h"
+
+#include <algorithm>
+
+#include "infofile/lexer.h"
+#include "infofile/parser.h"
+#include "infofile/reader.h"
+
+namespace infofile
+{
+    namespace
+    {
+        std::shared_ptr<Node> ParseSource(const std::string& filename, const char* data, std::size_t size, std::vector<std::string>* errors, std::vector<Node*>* containers)
+        {
+            auto reader = MemoryReader{filename, data, size};
+            auto lexer = Lexer(&reader, errors);
+            auto parser = Parser(&lexer);
+            parser.containers = containers;
+            auto parsed = parser.ReadRootNode();
+            ExpectEof(&lexer);
+            return parsed;
+        }
+
+        void ParseDocument(IncrementalDocument* document)
+        {
+            document->errors.clear();
+            document->nodes.clear();
+            document->root = ParseSource(document->filename, document->source.data(), document->source.size(), &document->errors, &document->nodes);
+
+            const auto found = document->errors.empty() && FindBrackets(document->source.data(), document->source.size(), &document->regions);
+            if (found == false || document->regions.size() != document->nodes.size())
+            {
+                document->regions.clear();
+                document->nodes.clear();
+            }
+        }
+
+        bool ParseRegion(IncrementalDocument* document, std::size_t offset, std::size_t removed, std::size_t inserted)
+        {
+            auto& regions = document->regions;
+            auto& nodes = document->nodes;
+
+            // the innermost region with the edit between it's brackets encloses the last region starting before the edit
+            const auto starts_after = std::partition_point(regions.begin(), regions.end(), [offset](const BracketRegion& region) { return region.begin < offset; });
+            auto index = starts_after == regions.begin() ? BracketRegion::NO_PARENT : static_cast<std::size_t>(starts_after - regions.begin()) - 1;
+            while (index != BracketRegion::NO_PARENT && offset + removed >= regions[index].end)
+            {
+                index = regions[index].parent;
+            }
+            if (index == BracketRegion::NO_PARENT)
+            {
+                return false;
+            }
+
+            const auto shift = [removed, inserted](std::size_t position) { return position - removed + inserted; };
+            const auto begin = regions[index].begin;
+            const auto old_end = regions[index].end;
+            const auto* data = document->source.data() + begin;
+            const auto size = shift(old_end) - begin;
+
+            std::vector<std::string> errors;
+            std::vector<Node*> containers;
+            auto parsed = ParseSource(document->filename, data, size, &errors, &containers);
+            std::vector<BracketRegion> inner;
+            if (errors.empty() == false || FindBrackets(data, size, &inner) == false || inner.size() != containers.size() || inner.empty() || inner[0].end != size || containers[0] != parsed.get())
+            {
+                return false;
+            }
+
+            nodes[index]->children = std::move(parsed->children);
+
+            // the regions inside the old region are replaced and everything after is moved
+            auto first_after = index + 1;
+            while (first_after < regions.size() && regions[first_after].begin < old_end)
+            {
+                first_after += 1;
+            }
+            const auto old_inner = first_after - index - 1;
+            const auto new_inner = inner.size() - 1;
+
+            for (auto i = first_after; i < regions.size(); i += 1)
+            {
+                auto& region = regions[i];
+                region.begin = shift(region.begin);
+                region.end = shift(region.end);
+                if (region.parent != BracketRegion::NO_PARENT && region.parent >= first_after)
+                {
+                    region.parent = region.parent - old_inner + new_inner;
+                }
+            }
+            for (auto i = index; i != BracketRegion::NO_PARENT; i = regions[i].parent)
+            {
+                regions[i].end = shift(regions[i].end);
+            }
+
+            for (std::size_t i = 1; i < inner.size(); i += 1)
+            {
+                inner[i].begin += begin;
+                inner[i].end += begin;
+                inner[i].parent += index;
+            }
+            const auto first = static_cast<std::ptrdiff_t>(index + 1);
+            const auto last = static_cast<std::ptrdiff_t>(first_after);
+            regions.erase(regions.begin() + first, regions.begin() + last);
+            regions.insert(regions.begin() + first, inner.begin() + 1, inner.end());
+            nodes.erase(nodes.begin() + first, nodes.begin() + last);
+            nodes.insert(nodes.begin() + first, containers.begin() + 1, containers.end());
+            return true;
+        }
+    }
+
+    IncrementalDocument ParseIncremental(const std::string& filename, const std::string& source)
+    {
+        IncrementalDocument document;
+        document.filename = filename;
+        document.source = source;
+        ParseDocument(&document);
+        return document;
+    }
+
+    bool ApplyEdit(IncrementalDocument* document, const TextEdit& edit)
+    {
+        const auto offset = std::min(edit.offset, document->source.size());
+        const auto removed = std::min(edit.removed, document->source.size() - offset);
+        document->source.replace(offset, removed, edit.inserted);
+
+        if (ParseRegion(document, offset, removed, edit.inserted.size()))
+        {
+            return true;
+        }
+
+        ParseDocument(document);
+        return false;
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "infofile/node.h"
+#include "infofile/split.h"
+
+namespace infofile
+{
+    /** A parsed source that can be updated with small text edits without parsing everything again.
+    */
+    struct IncrementalDocument
+    {
+        std::string filename;
+        std::string source;
+        std::shared_ptr<Node> root;
+        std::vector<std::string> errors;
+
+        /** The bracket regions of the source and the node each of them belongs to.
+        Empty if the source has errors, then the next edit parses everything.
+        */
+        std::vector<BracketRegion> regions;
+        std::vector<Node*> nodes;
+    };
+
+    /** Replace removed bytes at offset with the inserted text, the offset and length are clamped to the source.
+    */
+    struct TextEdit
+    {
+        std::size_t offset;
+        std::size_t removed;
+        std::string inserted;
+    };
+
+    IncrementalDocument ParseIncremental(const std::string& filename, const std::string& source);
+
+    /** Apply a edit to the source and update the tree.
+    Only the smallest {...} or [...] around the edit is parsed again and the children of it's node are replaced,
+    if that fails because the brackets no longer match or the region has errors everything is parsed.
+    Returns true if only a region was parsed.
+    */
+    bool ApplyEdit(IncrementalDocument* document, const TextEdit& edit);
+}
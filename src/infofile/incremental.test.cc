@@ -0,0 +1,63 @@
+#include "catch.hpp"
+#include "catchy/stringeq.h"
+#include "infofile/incremental.h"
+#include "infofile/infofile.h"
+
+using namespace infofile;
+
+namespace
+{
+    std::string PrintInline(const std::string& src)
+    {
+        std::vector<std::string> errors;
+        return PrintToString(PrintOptions{}, Parse("inline", src, &errors));
+    }
+}
+
+TEST_CASE("incremental", "[incremental]")
+{
+    auto document = ParseIncremental("inline", "a { b 1; c [1, 2, {d 3}] } e { f 4 }");
+    REQUIRE(document.errors.empty());
+    CHECK(4 == document.regions.size());
+    const auto* a = document.root->children[0].get();
+
+    SECTION("edit inside a array")
+    {
+        CHECK(ApplyEdit(&document, {document.source.find('2'), 1, "5, 6"}));
+        CHECK(catchy::StringEq(document.source, "a { b 1; c [1, 5, 6, {d 3}] } e { f 4 }"));
+        CHECK(catchy::StringEq(PrintToString(PrintOptions{}, document.root), PrintInline(document.source)));
+        CHECK(a == document.root->children[0].get());
+
+        // the regions after the edit have moved
+        CHECK(ApplyEdit(&document, {document.source.find('4'), 1, "7"}));
+        CHECK(ApplyEdit(&document, {document.source.find('3'), 0, "x "}));
+        CHECK(catchy::StringEq(PrintToString(PrintOptions{}, document.root), PrintInline("a { b 1; c [1, 5, 6, {d x 3}] } e { f 7 }")));
+    }
+
+    SECTION("new brackets")
+    {
+        CHECK(ApplyEdit(&document, {document.source.find("f 4"), 3, "g { h [i] }"}));
+        CHECK(ApplyEdit(&document, {document.source.find('i'), 1, "j, k"}));
+        CHECK(catchy::StringEq(PrintToString(PrintOptions{}, document.root), PrintInline("a { b 1; c [1, 2, {d 3}] } e { g { h [j, k] } }")));
+        CHECK(6 == document.regions.size());
+    }
+
+    SECTION("fall back to a full parse")
+    {
+        // top level
+        CHECK_FALSE(ApplyEdit(&document, {0, 1, "x"}));
+        CHECK(catchy::StringEq(PrintToString(PrintOptions{}, document.root), PrintInline("x { b 1; c [1, 2, {d 3}] } e { f 4 }")));
+
+        // brackets no longer match
+        CHECK_FALSE(ApplyEdit(&document, {document.source.find("b 1"), 0, "} y {"}));
+        CHECK(catchy::StringEq(PrintToString(PrintOptions{}, document.root), PrintInline("x { } y {b 1; c [1, 2, {d 3}] } e { f 4 }")));
+
+        // errors, and the next edit fixes them
+        CHECK_FALSE(ApplyEdit(&document, {document.source.find("f 4"), 0, "\""}));
+        CHECK_FALSE(document.errors.empty());
+        CHECK(document.regions.empty());
+        CHECK_FALSE(ApplyEdit(&document, {document.source.find('"'), 1, ""}));
+        CHECK(document.errors.empty());
+        CHECK(ApplyEdit(&document, {document.source.find("f 4"), 1, "g"}));
+    }
+}
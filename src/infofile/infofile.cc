@@ -1,16 +1,33 @@
 #include "infofile/infofile.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <sstream>
 
 #include "fmt/core.h"
+#include "infofile/bulkread.h"
+#include "infofile/compact.h"
 #include "infofile/file.h"
 #include "infofile/lexer.h"
 #include "infofile/parser.h"
+#include "infofile/parsestats.h"
+#include "infofile/prefetch.h"
+#include "infofile/printbuffer.h"
 #include "infofile/printstring.h"
 #include "infofile/reader.h"
+#include "infofile/split.h"
+#include "infofile/threadpool.h"
+
+#if !defined(_WIN32)
+#include <sys/uio.h>
+#endif
 
 namespace infofile
 {
@@ -22,100 +39,488 @@ namespace infofile
         : tab("  ")
         , newline("\n")
         , term(";")
+        , compact(false)
     {
     }
 
-    void PrintString(std::stringstream& ss, const std::string& str)
-    {
-        ss << PrintString(str);
-    }
-
-    void PrintNode(Printer* printer, int indent, const PrintOptions& po, std::shared_ptr<Node> node)
+    namespace
     {
-        std::string tab;
-        for (int i = 0; i < indent; ++i)
-        {
-            tab += po.tab;
-        }
-        std::stringstream ss;
-        ss << tab;
-        PrintString(ss, node->name);
-        ss << " ";
-        PrintString(ss, node->value);
-        if (node->children.empty() == false)
+        void PrintNode(PrintBuffer* buffer, IndentCache* indents, std::size_t depth, const PrintOptions& po, const Node& node)
         {
-            ss << " {" << po.newline;
-            printer->Print(ss.str());
-
-            for (std::shared_ptr<Node> c : node->children)
+            buffer->Write(indents->Get(depth));
+            buffer->WriteString(node.name);
+            buffer->Write(' ');
+            buffer->WriteString(node.value);
+            if (node.children.empty() == false)
             {
-                PrintNode(printer, indent + 1, po, c);
+                buffer->Write(" {");
+                buffer->Write(po.newline);
+
+                for (const auto& c : node.children)
+                {
+                    PrintNode(buffer, indents, depth + 1, po, *c);
+                }
+
+                buffer->Write(indents->Get(depth));
+                buffer->Write('}');
             }
 
-            ss.str("");
-            ss << tab << "}";
+            buffer->Write(po.term);
+            buffer->Write(po.newline);
         }
+    }
 
-        ss << po.term << po.newline;
-        printer->Print(ss.str());
+    void PrintBuffered(PrintBuffer* buffer, const PrintOptions& po, const Node& node)
+    {
+        if (po.compact)
+        {
+            PrintCompact(buffer, node);
+            return;
+        }
+        IndentCache indents{po.tab};
+        PrintNode(buffer, &indents, 0, po, node);
     }
 
     void Print(Printer* printer, const PrintOptions& po, std::shared_ptr<Node> node)
     {
-        PrintNode(printer, 0, po, node);
+        PrintBuffer buffer{[printer](std::string_view text) {
+            printer->Print(std::string{text});
+            return true;
+        }};
+        PrintBuffered(&buffer, po, *node);
     }
 
-    struct StdStringStreamPrinter : public Printer
+    std::string PrintToString(const PrintOptions& po, std::shared_ptr<Node> node)
     {
-        std::stringstream ss;
-        virtual void Print(const std::string& str)
+        std::string printed;
         {
-            ss << str;
+            PrintBuffer buffer{StringSink(&printed)};
+            PrintBuffered(&buffer, po, *node);
         }
-    };
+        return printed;
+    }
 
-    std::string PrintToString(const PrintOptions& po, std::shared_ptr<Node> node)
+    void PrintToConsole(const PrintOptions& po, std::shared_ptr<Node> node)
     {
-        StdStringStreamPrinter ss;
-        Print(&ss, po, node);
-        return ss.ss.str();
+        PrintBuffer buffer{[](std::string_view text) {
+            std::cout.write(text.data(), static_cast<std::streamsize>(text.size()));
+            return std::cout.good();
+        }};
+        PrintBuffered(&buffer, po, *node);
     }
 
-    struct CoutPrinter : public Printer
+    bool PrintToFileDescriptor(const PrintOptions& po, std::shared_ptr<Node> node, int fd)
     {
-        virtual void Print(const std::string& str)
-        {
-            std::cout << str;
-        }
-    };
+        PrintBuffer buffer{FileDescriptorSink(fd)};
+        PrintBuffered(&buffer, po, *node);
+        return buffer.Flush();
+    }
 
-    void PrintToConsole(const PrintOptions& po, std::shared_ptr<Node> node)
+    std::shared_ptr<Node> ParseFromFile(File* file, std::vector<std::string>* errors)
     {
-        CoutPrinter ss;
-        Print(&ss, po, node);
+        return ParseFromFile(file, errors, nullptr);
     }
 
-    std::shared_ptr<Node> ParseFromFile(File* file, std::vector<std::string>* errors)
+    std::shared_ptr<Node> ParseFromFile(File* file, std::vector<std::string>* errors, ParseStats* stats)
     {
+        using Clock = std::chrono::steady_clock;
+        const auto start = PARSE_STATS_ENABLED && stats != nullptr ? Clock::now() : Clock::time_point{};
+        const auto lexing = stats != nullptr ? stats->lexing : std::chrono::nanoseconds{0};
+
         auto lexer = Lexer(file, errors);
         auto parser = Parser(&lexer);
+        if constexpr (PARSE_STATS_ENABLED)
+        {
+            lexer.stats = stats;
+            parser.stats = stats;
+        }
         auto parsed = parser.ReadRootNode();
-        if (lexer.Peek().type != TokenType::ENDOFFILE)
+        ExpectEof(&lexer);
+
+        if constexpr (PARSE_STATS_ENABLED)
         {
-            lexer.ReportError(fmt::format("Expected EOF after node but found {} instead", lexer.Peek().ValueForPrint()));
+            if (stats != nullptr)
+            {
+                const auto total = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+                stats->bytes += file->position;
+                const auto lexed = stats->lexing - lexing;
+                stats->parsing += total - std::min(total, lexed);
+            }
         }
         return parsed;
     }
 
     std::shared_ptr<Node> Parse(const std::string& filename, const std::string& data, std::vector<std::string>* errors)
     {
-        auto reader = StringReader{filename, data};
-        return ParseFromFile(&reader, errors);
+        return Parse(filename, data, errors, nullptr);
+    }
+
+    std::shared_ptr<Node> Parse(const std::string& filename, const std::string& data, std::vector<std::string>* errors, ParseStats* stats)
+    {
+        auto reader = MemoryReader{filename, data.data(), data.size()};
+        return ParseFromFile(&reader, errors, stats);
     }
 
     std::shared_ptr<Node> ReadFile(const std::string& filename, std::vector<std::string>* errors)
+    {
+        return ReadFile(filename, errors, nullptr);
+    }
+
+    std::shared_ptr<Node> ReadFile(const std::string& filename, std::vector<std::string>* errors, ParseStats* stats)
     {
         auto reader = FileReader{filename};
+        return ParseFromFile(&reader, errors, stats);
+    }
+
+    std::shared_ptr<Node> ReadFilePrefetched(const std::string& filename, std::vector<std::string>* errors)
+    {
+        auto reader = PrefetchReader{filename};
         return ParseFromFile(&reader, errors);
     }
+
+    ReadFilesOptions::ReadFilesOptions()
+        : threads(0)
+    {
+    }
+
+    std::vector<FileResult> ReadFiles(const std::vector<std::string>& filenames, const ReadFilesOptions& options)
+    {
+        std::vector<FileResult> results(filenames.size());
+
+        auto read = [&filenames, &results](std::size_t index) {
+            auto& result = results[index];
+            result.filename = filenames[index];
+            result.root = ReadFile(result.filename, &result.errors);
+        };
+
+        const auto threads = options.threads == 0 ? DefaultThreadCount() : options.threads;
+        if (threads <= 1 || filenames.size() <= 1)
+        {
+            for (std::size_t i = 0; i < filenames.size(); i += 1)
+            {
+                read(i);
+            }
+            return results;
+        }
+
+        ThreadPool pool{std::min(threads, filenames.size())};
+        for (std::size_t i = 0; i < filenames.size(); i += 1)
+        {
+            pool.Submit([&read, i]() { read(i); });
+        }
+        pool.Wait();
+
+        return results;
+    }
+
+    ReadDirectoryOptions::ReadDirectoryOptions()
+        : threads(0)
+        , use_io_uring(true)
+    {
+    }
+
+    namespace
+    {
+        FileResult ErrorResult(const std::filesystem::path& path, const std::string& what, const std::error_code& error)
+        {
+            FileResult result;
+            result.filename = path.string();
+            result.errors.emplace_back(fmt::format("{}: Unable to {}, {}", result.filename, what, error.message()));
+            return result;
+        }
+
+        /** Walks the directories one at a time so a directory that can't be read is reported and the rest are still listed.
+        Like recursive_directory_iterator symlinks to directories are not followed.
+        */
+        void ListFiles(const std::string& directory, const std::string& extension, std::vector<std::string>* filenames, std::vector<FileResult>* errors)
+        {
+            std::vector<std::filesystem::path> directories = {directory};
+            while (directories.empty() == false)
+            {
+                const auto path = directories.back();
+                directories.pop_back();
+
+                std::error_code error;
+                auto it = std::filesystem::directory_iterator(path, error);
+                for (; !error && it != std::filesystem::directory_iterator(); it.increment(error))
+                {
+                    std::error_code entry_error;
+                    const auto status = it->symlink_status(entry_error);
+                    if (!entry_error && std::filesystem::is_directory(status))
+                    {
+                        directories.emplace_back(it->path());
+                    }
+                    else if (!entry_error && it->is_regular_file(entry_error) && (extension.empty() || it->path().extension() == extension))
+                    {
+                        filenames->emplace_back(it->path().string());
+                    }
+                    if (entry_error)
+                    {
+                        errors->emplace_back(ErrorResult(it->path(), "read entry", entry_error));
+                    }
+                }
+                if (error)
+                {
+                    errors->emplace_back(ErrorResult(path, "read directory", error));
+                }
+            }
+        }
+    }
+
+    std::vector<FileResult> ReadDirectory(const std::string& directory, const ReadDirectoryOptions& options)
+    {
+        std::vector<std::string> filenames;
+        std::vector<FileResult> errors;
+        ListFiles(directory, options.extension, &filenames, &errors);
+
+        std::vector<FileResult> results(filenames.size());
+        if (filenames.empty() == false)
+        {
+            BulkReadOptions bulk;
+            bulk.use_io_uring = options.use_io_uring;
+
+            ThreadPool pool{options.threads};
+            LoadFiles(filenames, bulk, &pool, [&filenames, &results](std::size_t index, std::string data) {
+                auto& result = results[index];
+                result.filename = filenames[index];
+                result.root = Parse(result.filename, data, &result.errors);
+            });
+        }
+
+        results.insert(results.end(), std::make_move_iterator(errors.begin()), std::make_move_iterator(errors.end()));
+        std::sort(results.begin(), results.end(), [](const FileResult& lhs, const FileResult& rhs) { return lhs.filename < rhs.filename; });
+        return results;
+    }
+
+
+    ParallelParseOptions::ParallelParseOptions()
+        : threads(0)
+        , chunk_size(1024 * 1024)
+    {
+    }
+
+    namespace
+    {
+        struct ParsedChunk
+        {
+            std::shared_ptr<Node> root;
+            std::vector<std::string> errors;
+            bool complete = true;
+        };
+
+        void ParseChunk(const std::string& filename, const char* data, std::size_t size, const SplitPoint& start, ParsedChunk* chunk)
+        {
+            auto reader = MemoryReader{filename, data, size};
+            reader.line = start.line;
+            reader.offset = start.offset;
+
+            auto lexer = Lexer(&reader, &chunk->errors);
+            auto parser = Parser(&lexer);
+            chunk->root = std::make_shared<Node>();
+            parser.ParseStructMembers(chunk->root);
+
+            // the parser gave up, so would parsing the whole file
+            chunk->complete = ExpectEof(&lexer);
+        }
+    }
+
+    std::shared_ptr<Node> ParseParallel(const std::string& filename, const std::string& data, std::vector<std::string>* errors, const ParallelParseOptions& options)
+    {
+        const auto threads = options.threads == 0 ? DefaultThreadCount() : options.threads;
+        if (threads <= 1 || data.size() < options.chunk_size * 2)
+        {
+            return Parse(filename, data, errors);
+        }
+
+        auto splits = FindTopLevelSplits(data.data(), data.size(), options.chunk_size);
+        if (splits.empty())
+        {
+            return Parse(filename, data, errors);
+        }
+        splits.insert(splits.begin(), SplitPoint{0, 0, 0});
+
+        std::vector<ParsedChunk> chunks(splits.size());
+        {
+            ThreadPool pool{std::min(threads, splits.size())};
+            for (std::size_t i = 0; i < splits.size(); i += 1)
+            {
+                pool.Submit([&, i]() {
+                    const auto start = splits[i].position;
+                    const auto end = i + 1 < splits.size() ? splits[i + 1].position : data.size();
+                    ParseChunk(filename, data.data() + start, end - start, splits[i], &chunks[i]);
+                });
+            }
+            pool.Wait();
+        }
+
+        auto root = std::make_shared<Node>();
+        for (auto& chunk : chunks)
+        {
+            errors->insert(errors->end(), chunk.errors.begin(), chunk.errors.end());
+            root->children.insert(root->children.end(), chunk.root->children.begin(), chunk.root->children.end());
+            if (chunk.complete == false)
+            {
+                break;
+            }
+        }
+        return root;
+    }
+
+    std::shared_ptr<Node> ReadFileParallel(const std::string& filename, std::vector<std::string>* errors, const ParallelParseOptions& options)
+    {
+        std::ifstream stream(filename, std::ios::binary);
+        std::ostringstream data;
+        data << stream.rdbuf();
+        return ParseParallel(filename, data.str(), errors, options);
+    }
+
+    ParallelPrintOptions::ParallelPrintOptions()
+        : threads(0)
+        , min_children(64)
+    {
+    }
+
+    namespace
+    {
+        /** The header of the root, the printed chunks of it's children and the footer, or nothing if it should be printed on a single thread.
+        */
+        std::vector<std::string> PrintChunks(const PrintOptions& po, const Node& node, const ParallelPrintOptions& options)
+        {
+            const auto threads = options.threads == 0 ? DefaultThreadCount() : options.threads;
+            const auto child_count = node.children.size();
+            if (po.compact || threads <= 1 || child_count < std::max<std::size_t>(options.min_children, 2))
+            {
+                return {};
+            }
+
+            // more chunks than threads evens out children of different sizes
+            const auto chunk_count = std::min(child_count, threads * 4);
+            std::vector<std::string> pieces(chunk_count + 2);
+            {
+                PrintBuffer header{StringSink(&pieces.front())};
+                header.WriteString(node.name);
+                header.Write(' ');
+                header.WriteString(node.value);
+                header.Write(" {");
+                header.Write(po.newline);
+            }
+
+            {
+                ThreadPool pool{std::min(threads, chunk_count)};
+                for (std::size_t i = 0; i < chunk_count; i += 1)
+                {
+                    pool.Submit([&, i]() {
+                        const auto first = child_count * i / chunk_count;
+                        const auto last = child_count * (i + 1) / chunk_count;
+                        PrintBuffer buffer{StringSink(&pieces[i + 1])};
+                        IndentCache indents{po.tab};
+                        for (auto child = first; child < last; child += 1)
+                        {
+                            PrintNode(&buffer, &indents, 1, po, *node.children[child]);
+                        }
+                    });
+                }
+                pool.Wait();
+            }
+
+            pieces.back() = "}" + po.term + po.newline;
+            return pieces;
+        }
+    }
+
+    void PrintParallel(PrintBuffer* buffer, const PrintOptions& po, const Node& node, const ParallelPrintOptions& options)
+    {
+        const auto pieces = PrintChunks(po, node, options);
+        if (pieces.empty())
+        {
+            PrintBuffered(buffer, po, node);
+            return;
+        }
+
+        for (const auto& piece : pieces)
+        {
+            buffer->WriteBlock(piece);
+        }
+    }
+
+    std::string PrintToStringParallel(const PrintOptions& po, std::shared_ptr<Node> node, const ParallelPrintOptions& options)
+    {
+        auto pieces = PrintChunks(po, *node, options);
+        if (pieces.empty())
+        {
+            return PrintToString(po, node);
+        }
+
+        std::size_t size = 0;
+        for (const auto& piece : pieces)
+        {
+            size += piece.size();
+        }
+        std::string printed;
+        printed.reserve(size);
+        for (const auto& piece : pieces)
+        {
+            printed += piece;
+        }
+        return printed;
+    }
+
+    bool PrintToFileDescriptorParallel(const PrintOptions& po, std::shared_ptr<Node> node, int fd, const ParallelPrintOptions& options)
+    {
+        const auto pieces = PrintChunks(po, *node, options);
+        if (pieces.empty())
+        {
+            return PrintToFileDescriptor(po, node, fd);
+        }
+
+#if defined(_WIN32)
+        const auto sink = FileDescriptorSink(fd);
+        for (const auto& piece : pieces)
+        {
+            if (sink(piece) == false)
+            {
+                return false;
+            }
+        }
+        return true;
+#else
+        std::vector<iovec> vectors;
+        for (const auto& piece : pieces)
+        {
+            if (piece.empty() == false)
+            {
+                vectors.emplace_back(iovec{const_cast<char*>(piece.data()), piece.size()});
+            }
+        }
+
+        std::size_t next = 0;
+        while (next < vectors.size())
+        {
+            const auto count = static_cast<int>(std::min<std::size_t>(vectors.size() - next, IOV_MAX));
+            auto written = writev(fd, vectors.data() + next, count);
+            if (written < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (written <= 0)
+            {
+                return false;
+            }
+
+            // skip what was written, a vector may be partially written
+            auto left = static_cast<std::size_t>(written);
+            while (next < vectors.size() && left >= vectors[next].iov_len)
+            {
+                left -= vectors[next].iov_len;
+                next += 1;
+            }
+            if (left > 0)
+            {
+                vectors[next].iov_base = static_cast<char*>(vectors[next].iov_base) + left;
+                vectors[next].iov_len -= left;
+            }
+        }
+        return true;
+#endif
+    }
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <vector>
@@ -20,13 +21,135 @@ namespace infofile
         std::string tab;
         std::string newline;
         std::string term;
+
+        /** Print as few bytes as possible while still parsing to the same tree, see compact.h.
+        tab, newline and term are not used.
+        */
+        bool compact;
     };
 
+    struct PrintBuffer;
+
+    /** Print into a buffer that passes the text on to it's sink in large blocks, see printbuffer.h.
+    */
+    void PrintBuffered(PrintBuffer* buffer, const PrintOptions& po, const Node& node);
+
     void Print(Printer* printer, const PrintOptions& po, std::shared_ptr<Node> node);
     std::string PrintToString(const PrintOptions& po, std::shared_ptr<Node> node);
     void PrintToConsole(const PrintOptions& po, std::shared_ptr<Node> node);
 
+    /** Print to a file descriptor such as 1 for stdout, returns false if the writing failed.
+    */
+    bool PrintToFileDescriptor(const PrintOptions& po, std::shared_ptr<Node> node, int fd);
+
+    struct File;
+
+    /** Parse everything from a custom source.
+    */
+    std::shared_ptr<Node> ParseFromFile(File* file, std::vector<std::string>* errors);
+
     std::shared_ptr<Node> Parse(const std::string& filename, const std::string& data, std::vector<std::string>* errors);
     std::shared_ptr<Node> ReadFile(const std::string& filename, std::vector<std::string>* errors);
 
+    struct ParseStats;
+
+    /** Like above but also reports what the parse did, see parsestats.h.
+    */
+    std::shared_ptr<Node> ParseFromFile(File* file, std::vector<std::string>* errors, ParseStats* stats);
+    std::shared_ptr<Node> Parse(const std::string& filename, const std::string& data, std::vector<std::string>* errors, ParseStats* stats);
+    std::shared_ptr<Node> ReadFile(const std::string& filename, std::vector<std::string>* errors, ParseStats* stats);
+
+    /** Like ReadFile but the file is read in large blocks on a background thread while it's being parsed.
+    Useful for large files on slow disks or pipes.
+    */
+    std::shared_ptr<Node> ReadFilePrefetched(const std::string& filename, std::vector<std::string>* errors);
+
+    struct ReadFilesOptions
+    {
+        ReadFilesOptions();
+
+        /** Number of worker threads, 0 means one per hardware thread.
+        */
+        std::size_t threads;
+    };
+
+    struct FileResult
+    {
+        std::string filename;
+        std::shared_ptr<Node> root;
+        std::vector<std::string> errors;
+    };
+
+    /** Read several files in parallel.
+    The result is in the same order as the filenames and every file gets its own list of errors.
+    */
+    std::vector<FileResult> ReadFiles(const std::vector<std::string>& filenames, const ReadFilesOptions& options);
+
+    struct ReadDirectoryOptions
+    {
+        ReadDirectoryOptions();
+
+        /** Number of threads parsing the files, 0 means one per hardware thread.
+        */
+        std::size_t threads;
+
+        /** Only read files with this extension, like ".info". Empty means all files.
+        */
+        std::string extension;
+
+        /** Load the files with io_uring on linux, otherwise or if not available each file is read on the pool.
+        */
+        bool use_io_uring;
+    };
+
+    /** Read all files in a directory and it's subdirectories.
+    The result is sorted by filename and every file gets its own list of errors.
+    A directory or entry that can't be read is skipped and listed with a null root and the error,
+    so a missing directory gives a single result with the error.
+    */
+    std::vector<FileResult> ReadDirectory(const std::string& directory, const ReadDirectoryOptions& options);
+
+    struct ParallelParseOptions
+    {
+        ParallelParseOptions();
+
+        /** Number of worker threads, 0 means one per hardware thread.
+        */
+        std::size_t threads;
+
+        /** Minimum number of bytes in each chunk.
+        */
+        std::size_t chunk_size;
+    };
+
+    /** Parse a single large root node without braces by splitting it into chunks at top level nodes
+    and parsing the chunks in parallel.
+    The result and the errors are the same as when calling Parse.
+    */
+    std::shared_ptr<Node> ParseParallel(const std::string& filename, const std::string& data, std::vector<std::string>* errors, const ParallelParseOptions& options);
+    std::shared_ptr<Node> ReadFileParallel(const std::string& filename, std::vector<std::string>* errors, const ParallelParseOptions& options);
+
+    struct ParallelPrintOptions
+    {
+        ParallelPrintOptions();
+
+        /** Number of worker threads, 0 means one per hardware thread.
+        */
+        std::size_t threads;
+
+        /** Roots with fewer children than this are printed on the calling thread.
+        */
+        std::size_t min_children;
+    };
+
+    /** Print the children of the root in chunks on several threads, the output is the same as when printing
+    on a single thread.
+    Every chunk is kept in memory until all are printed and then passed to the sink in order.
+    */
+    void PrintParallel(PrintBuffer* buffer, const PrintOptions& po, const Node& node, const ParallelPrintOptions& options);
+    std::string PrintToStringParallel(const PrintOptions& po, std::shared_ptr<Node> node, const ParallelPrintOptions& options);
+
+    /** Like PrintParallel but all chunks are written with a single writev when possible.
+    */
+    bool PrintToFileDescriptorParallel(const PrintOptions& po, std::shared_ptr<Node> node, int fd, const ParallelPrintOptions& options);
 }
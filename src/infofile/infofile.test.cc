@@ -1,7 +1,10 @@
 #include <cstring>
+#include <filesystem>
+#include <fstream>
 
 #include "catch.hpp"
 #include "catchy/stringeq.h"
+#include "fmt/core.h"
 #include "infofile/infofile.h"
 
 using namespace infofile;
@@ -921,3 +924,62 @@ TEST_CASE("test_unicode_escape", "[infofile]")
 
 }
 */
+
+TEST_CASE("test_read_files", "[infofile]")
+{
+    const auto dir = std::filesystem::temp_directory_path();
+    std::vector<std::string> filenames;
+    for (int i = 0; i < 20; i += 1)
+    {
+        const auto path = (dir / fmt::format("infofile_test_read_files_{}.info", i)).string();
+        std::ofstream f{path, std::ios::binary};
+        if (i == 7)
+        {
+            f << "key \"missing quote";
+        }
+        else
+        {
+            f << "key " << i;
+        }
+        filenames.emplace_back(path);
+    }
+
+    ReadFilesOptions options;
+    options.threads = 4;
+    const auto results = ReadFiles(filenames, options);
+
+    REQUIRE(20 == results.size());
+    for (int i = 0; i < 20; i += 1)
+    {
+        const auto& r = results[static_cast<std::size_t>(i)];
+        CHECK(filenames[static_cast<std::size_t>(i)] == r.filename);
+        REQUIRE(r.root != nullptr);
+        REQUIRE(1 == r.root->children.size());
+        CHECK("key" == r.root->children[0]->name);
+        if (i == 7)
+        {
+            CHECK(1 == r.errors.size());
+            CHECK("missing quote" == r.root->children[0]->value);
+        }
+        else
+        {
+            CHECK(r.errors.empty());
+            CHECK(fmt::format("{}", i) == r.root->children[0]->value);
+        }
+    }
+
+    for (const auto& f : filenames)
+    {
+        std::filesystem::remove(f);
+    }
+}
+
+TEST_CASE("test_heredoc_error_line", "[infofile]")
+{
+    std::vector<std::string> errors;
+    std::string src = "a <<EOF\nb\nEOF\n$";
+    std::shared_ptr<infofile::Node> val = infofile::Parse("inline", src, &errors);
+
+    REQUIRE(errors.size() == 3);
+    CHECK(catchy::StringEq(errors[0], "inline(4:1): Unknown character $"));
+}
@@ -6,6 +6,7 @@
 #include "fmt/core.h"
 #include "infofile/chars.h"
 #include "infofile/file.h"
+#include "infofile/parsestats.h"
 #include "infofile/printstring.h"
 
 namespace infofile
@@ -13,6 +14,8 @@ namespace infofile
     Token::Token(TokenType t, const std::string& v)
         : type(t)
         , value(v)
+        , begin(0)
+        , end(0)
     {
     }
 
@@ -31,6 +34,8 @@ namespace infofile
     Lexer::Lexer(File* f, std::vector<std::string>* e)
         : file(f)
         , errors(e)
+        , last_end(0)
+        , stats(nullptr)
     {
     }
 
@@ -90,6 +95,14 @@ namespace infofile
                 file->Read();
                 ss << '\t';
                 break;
+            case 'r':
+                file->Read();
+                ss << '\r';
+                break;
+            case '\\':
+                file->Read();
+                ss << '\\';
+                break;
             case '0':
                 file->Read();
                 ss << '\0';
@@ -257,8 +270,8 @@ namespace infofile
                         {
                             ReportError("EOF name is empty");
                         }
-                        mystate = 1;
-                        file->Unput(c);
+                        // the whitespace is already read, so a newline means the doc starts directly
+                        mystate = c == '\n' ? 2 : 1;
                     }
                     else
                     {
@@ -519,8 +532,45 @@ namespace infofile
         }
     }
 
+    Lexer::Clock::time_point Lexer::StartTokenStats() const
+    {
+        if constexpr (PARSE_STATS_ENABLED)
+        {
+            if (stats != nullptr)
+            {
+                return Clock::now();
+            }
+        }
+        return {};
+    }
+
+    void Lexer::CountToken(const Token& token, Clock::time_point start)
+    {
+        if constexpr (PARSE_STATS_ENABLED)
+        {
+            if (stats != nullptr)
+            {
+                stats->lexing += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+                stats->tokens[static_cast<std::size_t>(token.type)] += 1;
+                stats->string_bytes_copied += token.value.size();
+            }
+        }
+    }
+
+    void Lexer::CountCopy(const Token& token)
+    {
+        if constexpr (PARSE_STATS_ENABLED)
+        {
+            if (stats != nullptr)
+            {
+                stats->string_bytes_copied += token.value.size();
+            }
+        }
+    }
+
     Token Lexer::DoRead()
     {
+        const auto start = StartTokenStats();
         SkipWhitespace();
 
         while (file->Peek() == '/')
@@ -543,6 +593,16 @@ namespace infofile
             SkipWhitespace();
         }
 
+        const auto begin = file->position;
+        auto token = ReadToken();
+        token.begin = begin;
+        token.end = file->position;
+        CountToken(token, start);
+        return token;
+    }
+
+    Token Lexer::ReadToken()
+    {
         const auto c = file->Peek();
         switch (c)
         {
@@ -638,25 +698,36 @@ namespace infofile
         if (next)
         {
             auto r = *next;
+            CountCopy(r);
             next = std::nullopt;
+            last_end = r.end;
             return r;
         }
         else
         {
-            return DoRead();
+            auto r = DoRead();
+            last_end = r.end;
+            return r;
         }
     }
 
     Token Lexer::Peek()
     {
-        if (next)
+        if (next.has_value() == false)
         {
-            return *next;
+            next = DoRead();
         }
-        else
+        CountCopy(*next);
+        return *next;
+    }
+
+    bool ExpectEof(Lexer* lexer)
+    {
+        if (lexer->Peek().type != TokenType::ENDOFFILE)
         {
-            next = DoRead();
-            return *next;
+            lexer->ReportError(fmt::format("Expected EOF after node but found {} instead", lexer->Peek().ValueForPrint()));
+            return false;
         }
+        return true;
     }
-}
\ No newline at end of file
+}
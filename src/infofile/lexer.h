@@ -1,5 +1,7 @@
 #pragma once
 
+#include <chrono>
+#include <cstddef>
 #include <optional>
 #include <string>
 #include <vector>
@@ -7,6 +9,7 @@
 namespace infofile
 {
     struct File;
+    struct ParseStats;
 
     enum class TokenType
     {
@@ -27,6 +30,11 @@ namespace infofile
         TokenType type;
         std::string value;
 
+        /** Byte offsets of the token in the source, end is one past the last character.
+        */
+        std::size_t begin;
+        std::size_t end;
+
         Token(TokenType t, const std::string& v);
 
         std::string ValueForPrint() const;
@@ -49,6 +57,13 @@ namespace infofile
         void EatMultilineComment();
 
         Token DoRead();
+        Token ReadToken();
+
+        using Clock = std::chrono::steady_clock;
+        Clock::time_point StartTokenStats() const;
+        void CountToken(const Token& token, Clock::time_point start);
+        void CountCopy(const Token& token);
+
         void ReportError(const std::string& error);
 
         Token Read();
@@ -58,5 +73,17 @@ namespace infofile
         std::vector<std::string>* errors;
 
         std::optional<Token> next;
+
+        /** End offset of the last token returned by Read().
+        */
+        std::size_t last_end;
+
+        /** If set, the tokens and the time spent reading them are counted here, see parsestats.h.
+        */
+        ParseStats* stats;
     };
-}
\ No newline at end of file
+
+    /** Report a error if there is anything left, returns false in that case.
+    */
+    bool ExpectEof(Lexer* lexer);
+}
@@ -0,0 +1,330 @@
+#include "infofile/mapped.h"
+
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <unordered_map>
+
+#include "fmt/core.h"
+
+#if defined(_WIN32)
+#define INFOFILE_NO_MMAP 1
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace infofile
+{
+    namespace
+    {
+        constexpr char MAGIC[] = {'I', 'N', 'F', 'M'};
+        constexpr std::uint32_t VERSION = 1;
+
+        // counts and indices are stored as 32 bit
+        constexpr std::size_t MAX_COUNT = std::numeric_limits<std::uint32_t>::max();
+
+        // the index of a node that doesn't exist, such as a child past the end
+        constexpr std::uint32_t INVALID_NODE = std::numeric_limits<std::uint32_t>::max();
+
+        // magic, version, node count, string count
+        constexpr std::size_t HEADER_SIZE = 16;
+
+        // name, value, first child, child count
+        constexpr std::size_t NODE_FIELDS = 4;
+        constexpr std::size_t NODE_SIZE = NODE_FIELDS * 4;
+
+        // offset, size, both relative to the string data
+        constexpr std::size_t STRING_SIZE = 16;
+
+        enum Field
+        {
+            NAME = 0,
+            VALUE = 1,
+            FIRST_CHILD = 2,
+            CHILD_COUNT = 3
+        };
+
+        void Write32(std::string* out, std::uint32_t value)
+        {
+            for (int i = 0; i < 4; i += 1)
+            {
+                out->push_back(static_cast<char>((value >> (i * 8)) & 0xFF));
+            }
+        }
+
+        void Write64(std::string* out, std::uint64_t value)
+        {
+            for (int i = 0; i < 8; i += 1)
+            {
+                out->push_back(static_cast<char>((value >> (i * 8)) & 0xFF));
+            }
+        }
+
+        std::uint32_t Read32(const char* data)
+        {
+            const auto* bytes = reinterpret_cast<const unsigned char*>(data);
+            return static_cast<std::uint32_t>(bytes[0]) | (static_cast<std::uint32_t>(bytes[1]) << 8) | (static_cast<std::uint32_t>(bytes[2]) << 16) | (static_cast<std::uint32_t>(bytes[3]) << 24);
+        }
+
+        std::uint64_t Read64(const char* data)
+        {
+            return static_cast<std::uint64_t>(Read32(data)) | (static_cast<std::uint64_t>(Read32(data + 4)) << 32);
+        }
+    }
+
+    std::string WriteMapped(std::shared_ptr<Node> node)
+    {
+        std::unordered_map<std::string, std::uint32_t> string_index;
+        std::vector<const std::string*> strings;
+        auto intern = [&](const std::string& str) -> std::uint32_t {
+            auto found = string_index.find(str);
+            if (found != string_index.end())
+            {
+                return found->second;
+            }
+            const auto index = static_cast<std::uint32_t>(strings.size());
+            const auto inserted = string_index.emplace(str, index);
+            strings.emplace_back(&inserted.first->first);
+            return index;
+        };
+
+        // breadth first so all children of a node are next to each other
+        std::vector<const Node*> order = {node.get()};
+        std::string nodes;
+        for (std::size_t i = 0; i < order.size(); i += 1)
+        {
+            const auto* n = order[i];
+            // strings are at most two per node so they fit when the nodes do
+            if (order.size() + n->children.size() > MAX_COUNT / 2)
+            {
+                return {};
+            }
+            Write32(&nodes, intern(n->name));
+            Write32(&nodes, intern(n->value));
+            Write32(&nodes, static_cast<std::uint32_t>(order.size()));
+            Write32(&nodes, static_cast<std::uint32_t>(n->children.size()));
+            for (const auto& child : n->children)
+            {
+                order.emplace_back(child.get());
+            }
+        }
+
+        std::string out;
+        out.append(MAGIC, sizeof(MAGIC));
+        Write32(&out, VERSION);
+        Write32(&out, static_cast<std::uint32_t>(order.size()));
+        Write32(&out, static_cast<std::uint32_t>(strings.size()));
+        out.append(nodes);
+
+        std::uint64_t string_offset = 0;
+        for (const auto* str : strings)
+        {
+            Write64(&out, string_offset);
+            Write64(&out, str->size());
+            string_offset += str->size();
+        }
+        for (const auto* str : strings)
+        {
+            out.append(*str);
+        }
+        return out;
+    }
+
+    bool WriteMappedFile(const std::string& filename, std::shared_ptr<Node> node)
+    {
+        const auto data = WriteMapped(node);
+        if (data.empty())
+        {
+            return false;
+        }
+        std::ofstream stream(filename, std::ios::binary);
+        stream.write(data.data(), static_cast<std::streamsize>(data.size()));
+        return stream.good();
+    }
+
+    MappedNode::MappedNode(const MappedTree* t, std::uint32_t i)
+        : tree(t)
+        , index(i)
+    {
+    }
+
+    std::string_view MappedNode::Name() const
+    {
+        return IsValid() ? tree->String(tree->NodeField(index, NAME)) : std::string_view{};
+    }
+
+    std::string_view MappedNode::Value() const
+    {
+        return IsValid() ? tree->String(tree->NodeField(index, VALUE)) : std::string_view{};
+    }
+
+    std::size_t MappedNode::ChildCount() const
+    {
+        const auto first = tree->NodeField(index, FIRST_CHILD);
+        const auto count = tree->NodeField(index, CHILD_COUNT);
+        // a corrupt file may point outside the nodes
+        if (first > tree->node_count || count > tree->node_count - first)
+        {
+            return 0;
+        }
+        return count;
+    }
+
+    MappedNode MappedNode::Child(std::size_t child) const
+    {
+        if (child >= ChildCount())
+        {
+            return {tree, INVALID_NODE};
+        }
+        return {tree, tree->NodeField(index, FIRST_CHILD) + static_cast<std::uint32_t>(child)};
+    }
+
+    bool MappedNode::IsValid() const
+    {
+        return index < tree->node_count;
+    }
+
+    MappedTree::MappedTree()
+        : data(nullptr)
+        , size(0)
+        , node_count(0)
+        , string_count(0)
+        , nodes_offset(0)
+        , strings_offset(0)
+        , string_data_offset(0)
+        , mapping(nullptr)
+        , mapping_size(0)
+    {
+    }
+
+    MappedTree::~MappedTree()
+    {
+        Close();
+    }
+
+    bool MappedTree::View(const std::string& filename, const char* d, std::size_t s, std::vector<std::string>* errors)
+    {
+        auto error = [&](const std::string& message) {
+            errors->emplace_back(fmt::format("{}: {}", filename, message));
+            Close();
+            return false;
+        };
+
+        if (s < HEADER_SIZE || std::memcmp(d, MAGIC, sizeof(MAGIC)) != 0)
+        {
+            return error("Not a mapped info file");
+        }
+        if (Read32(d + 4) != VERSION)
+        {
+            return error(fmt::format("Unsupported mapped version {}", Read32(d + 4)));
+        }
+
+        data = d;
+        size = s;
+        node_count = Read32(d + 8);
+        string_count = Read32(d + 12);
+        nodes_offset = HEADER_SIZE;
+        strings_offset = nodes_offset + std::size_t{node_count} * NODE_SIZE;
+        string_data_offset = strings_offset + std::size_t{string_count} * STRING_SIZE;
+        if (node_count == 0 || string_data_offset > size)
+        {
+            return error("Node or string table is truncated");
+        }
+        return true;
+    }
+
+    bool MappedTree::Open(const std::string& filename, std::vector<std::string>* errors)
+    {
+        Close();
+
+#if defined(INFOFILE_NO_MMAP)
+        std::ifstream stream(filename, std::ios::binary);
+        std::ostringstream content;
+        content << stream.rdbuf();
+        memory = content.str();
+        return View(filename, memory.data(), memory.size(), errors);
+#else
+        const int fd = open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            errors->emplace_back(fmt::format("{}: Unable to open file", filename));
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size <= 0)
+        {
+            close(fd);
+            errors->emplace_back(fmt::format("{}: Unable to read file", filename));
+            return false;
+        }
+        const auto file_size = static_cast<std::size_t>(info.st_size);
+        void* mapped = mmap(nullptr, file_size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapped == MAP_FAILED)
+        {
+            errors->emplace_back(fmt::format("{}: Unable to map file", filename));
+            return false;
+        }
+        mapping = mapped;
+        mapping_size = file_size;
+        return View(filename, static_cast<const char*>(mapped), file_size, errors);
+#endif
+    }
+
+    MappedNode MappedTree::Root() const
+    {
+        return {this, 0};
+    }
+
+    std::size_t MappedTree::NodeCount() const
+    {
+        return node_count;
+    }
+
+    std::string_view MappedTree::String(std::uint32_t string_index) const
+    {
+        if (string_index >= string_count)
+        {
+            return {};
+        }
+        const auto* entry = data + strings_offset + std::size_t{string_index} * STRING_SIZE;
+        const auto offset = Read64(entry);
+        const auto length = Read64(entry + 8);
+        const auto available = size - string_data_offset;
+        if (offset > available || length > available - offset)
+        {
+            return {};
+        }
+        return {data + string_data_offset + offset, length};
+    }
+
+    std::uint32_t MappedTree::NodeField(std::uint32_t node_index, std::size_t field) const
+    {
+        if (node_index >= node_count)
+        {
+            return 0;
+        }
+        return Read32(data + nodes_offset + std::size_t{node_index} * NODE_SIZE + field * 4);
+    }
+
+    void MappedTree::Close()
+    {
+#if !defined(INFOFILE_NO_MMAP)
+        if (mapping != nullptr)
+        {
+            munmap(mapping, mapping_size);
+        }
+#endif
+        mapping = nullptr;
+        mapping_size = 0;
+        memory.clear();
+        data = nullptr;
+        size = 0;
+        node_count = 0;
+        string_count = 0;
+    }
+}
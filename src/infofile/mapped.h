@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "infofile/node.h"
+
+namespace infofile
+{
+    /** Serialize a tree to the mappable binary format.
+    Unlike WriteBinary everything has a fixed size so the tree can be navigated where it is stored:
+    a header, all nodes in breadth first order so the children of a node are next to each other,
+    a table of the unique strings and then the string data.
+    Numbers are stored little endian.
+    Returns a empty string if the tree has too many nodes to be indexed with 32 bits.
+    */
+    std::string WriteMapped(std::shared_ptr<Node> node);
+    bool WriteMappedFile(const std::string& filename, std::shared_ptr<Node> node);
+
+    struct MappedTree;
+
+    /** A node in a MappedTree, a cheap handle that is only valid as long as the tree.
+    */
+    struct MappedNode
+    {
+        MappedNode(const MappedTree* t, std::uint32_t i);
+
+        std::string_view Name() const;
+        std::string_view Value() const;
+
+        std::size_t ChildCount() const;
+
+        /** A child past the end is a invalid node with a empty name and value and no children.
+        */
+        MappedNode Child(std::size_t index) const;
+
+        bool IsValid() const;
+
+        const MappedTree* tree;
+        std::uint32_t index;
+    };
+
+    /** A read only tree on top of data written by WriteMapped.
+    Opening only checks the header, nodes and strings are read directly from the data when accessed.
+    */
+    struct MappedTree
+    {
+        MappedTree();
+        ~MappedTree();
+
+        MappedTree(const MappedTree&) = delete;
+        void operator=(const MappedTree&) = delete;
+
+        /** View data owned by someone else, it must outlive the tree.
+        */
+        bool View(const std::string& filename, const char* d, std::size_t s, std::vector<std::string>* errors);
+
+        /** Memory map a file, on platforms without mmap the file is read to memory.
+        */
+        bool Open(const std::string& filename, std::vector<std::string>* errors);
+
+        MappedNode Root() const;
+
+        std::size_t NodeCount() const;
+
+        std::string_view String(std::uint32_t string_index) const;
+        std::uint32_t NodeField(std::uint32_t node_index, std::size_t field) const;
+
+        void Close();
+
+        const char* data;
+        std::size_t size;
+        std::uint32_t node_count;
+        std::uint32_t string_count;
+        std::size_t nodes_offset;
+        std::size_t strings_offset;
+        std::size_t string_data_offset;
+
+        void* mapping;
+        std::size_t mapping_size;
+        std::string memory;
+    };
+}
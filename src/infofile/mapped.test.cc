@@ -0,0 +1,83 @@
+#include <filesystem>
+
+#include "catch.hpp"
+#include "catchy/stringeq.h"
+#include "infofile/infofile.h"
+#include "infofile/mapped.h"
+
+using namespace infofile;
+
+namespace
+{
+    void CheckSame(const Node& node, const MappedNode& mapped)
+    {
+        CHECK(catchy::StringEq(std::string(mapped.Name()), node.name));
+        CHECK(catchy::StringEq(std::string(mapped.Value()), node.value));
+        REQUIRE(node.children.size() == mapped.ChildCount());
+        for (std::size_t i = 0; i < node.children.size(); i += 1)
+        {
+            CheckSame(*node.children[i], mapped.Child(i));
+        }
+    }
+}
+
+TEST_CASE("mapped tree", "[mapped]")
+{
+    std::vector<std::string> errors;
+    const auto parsed = Parse("inline", "a { b c { d e } f [g h] } i j { k l } \"x\\0y\" \"\"", &errors);
+    REQUIRE(errors.empty());
+    const auto data = WriteMapped(parsed);
+
+    SECTION("view")
+    {
+        MappedTree tree;
+        REQUIRE(tree.View("inline", data.data(), data.size(), &errors));
+        CHECK(10 == tree.NodeCount());
+        CheckSame(*parsed, tree.Root());
+    }
+
+    SECTION("child past the end")
+    {
+        MappedTree tree;
+        REQUIRE(tree.View("inline", data.data(), data.size(), &errors));
+        const auto d = tree.Root().Child(0).Child(0).Child(0);
+        REQUIRE(d.IsValid());
+        CHECK(d.Name() == "d");
+        REQUIRE(0 == d.ChildCount());
+        const auto missing = d.Child(0);
+        CHECK_FALSE(missing.IsValid());
+        CHECK(missing.Name().empty());
+        CHECK(missing.Value().empty());
+        CHECK(0 == missing.ChildCount());
+        CHECK_FALSE(tree.Root().Child(99).IsValid());
+    }
+
+    SECTION("file")
+    {
+        const auto path = (std::filesystem::temp_directory_path() / "infofile_test_mapped.infom").string();
+        REQUIRE(WriteMappedFile(path, parsed));
+        {
+            MappedTree tree;
+            REQUIRE(tree.Open(path, &errors));
+            CheckSame(*parsed, tree.Root());
+        }
+        std::filesystem::remove(path);
+    }
+
+    SECTION("bad data")
+    {
+        MappedTree tree;
+        CHECK_FALSE(tree.View("bad", "key value", 9, &errors));
+        CHECK_FALSE(tree.View("bad", data.data(), 20, &errors));
+        CHECK(2 == errors.size());
+    }
+
+    SECTION("truncated strings")
+    {
+        // only the header is checked on open, missing strings are empty
+        MappedTree tree;
+        REQUIRE(tree.View("bad", data.data(), data.size() - 1, &errors));
+        CHECK(tree.Root().Child(0).Child(1).Child(0).Value() == "g");
+        CHECK(tree.Root().Child(0).Child(1).Child(1).Value().empty());
+    }
+}
@@ -17,4 +17,15 @@ namespace infofile
         , value(v)
     {
     }
+
+    std::shared_ptr<Node> DeepCopy(const Node& node)
+    {
+        auto copy = std::make_shared<Node>(node.name, node.value);
+        copy->children.reserve(node.children.size());
+        for (const auto& child : node.children)
+        {
+            copy->children.emplace_back(DeepCopy(*child));
+        }
+        return copy;
+    }
 }
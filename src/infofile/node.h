@@ -18,4 +18,8 @@ namespace infofile
         std::string value;
         std::vector<std::shared_ptr<Node>> children;
     };
+
+    /** Copy a node and all of it's children.
+    */
+    std::shared_ptr<Node> DeepCopy(const Node& node);
 }
\ No newline at end of file
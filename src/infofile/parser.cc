@@ -1,12 +1,15 @@
 #include "infofile/parser.h"
 
+#include <algorithm>
 #include <cassert>
 #include <sstream>
 
 #include "fmt/core.h"
 #include "infofile/lexer.h"
 #include "infofile/node.h"
+#include "infofile/parsestats.h"
 #include "infofile/printstring.h"
+#include "infofile/spans.h"
 
 namespace infofile
 {
@@ -24,29 +27,113 @@ namespace infofile
 
             return false;
         }
+
+        std::size_t HeapSize(const std::string& str)
+        {
+            static const auto small_capacity = std::string{}.capacity();
+            return str.capacity() > small_capacity ? 1 : 0;
+        }
     }
 
     Parser::Parser(Lexer* l)
         : lexer(l)
+        , containers(nullptr)
+        , spans(nullptr)
+        , stats(nullptr)
+        , depth(0)
+    {
+    }
+
+    void Parser::CountNode(const Node& node)
+    {
+        if constexpr (PARSE_STATS_ENABLED)
+        {
+            if (stats != nullptr)
+            {
+                const auto size = node.name.size() + node.value.size();
+                stats->nodes += 1;
+                stats->string_bytes_referenced += size;
+                stats->string_bytes_copied += size;
+                stats->heap_allocations += 1 + HeapSize(node.name) + HeapSize(node.value);
+            }
+        }
+    }
+
+    void Parser::AddChild(std::shared_ptr<Node> root, std::shared_ptr<Node> node)
     {
+        const auto capacity = root->children.capacity();
+        root->children.emplace_back(node);
+        if constexpr (PARSE_STATS_ENABLED)
+        {
+            if (stats != nullptr && root->children.capacity() != capacity)
+            {
+                stats->heap_allocations += 1;
+            }
+        }
+    }
+
+    void Parser::EnterBody()
+    {
+        depth += 1;
+        if constexpr (PARSE_STATS_ENABLED)
+        {
+            if (stats != nullptr)
+            {
+                stats->max_depth = std::max(stats->max_depth, depth);
+            }
+        }
+    }
+
+    void Parser::LeaveBody()
+    {
+        depth -= 1;
+    }
+
+    Span Parser::ParseBody(std::shared_ptr<Node> root)
+    {
+        const auto begin = lexer->Peek().begin;
+        switch (lexer->Peek().type)
+        {
+        case TokenType::ARRAY_BEGIN:
+            EnterBody();
+            ParseArray(root);
+            LeaveBody();
+            break;
+        case TokenType::STRUCT_BEGIN:
+            EnterBody();
+            ParseStruct(root);
+            LeaveBody();
+            break;
+        default:
+            return {};
+        }
+        return {begin, lexer->last_end};
     }
 
     std::shared_ptr<Node> Parser::ReadRootNode()
     {
         auto first_token = lexer->Peek();
         auto node = std::make_shared<Node>();
+        CountNode(*node);
+        NodeSpans s;
         switch (first_token.type)
         {
         case TokenType::ARRAY_BEGIN:
-            ParseArray(node);
-            return node;
         case TokenType::STRUCT_BEGIN:
-            ParseStruct(node);
-            return node;
+            s.body = ParseBody(node);
+            break;
         default:
             ParseStructMembers(node);
-            return node;
+            break;
         }
+
+        if (spans != nullptr)
+        {
+            s.node = {first_token.begin, std::max(first_token.begin, lexer->last_end)};
+            spans->root = node.get();
+            spans->Add(node.get(), s);
+        }
+        return node;
     }
 
     std::shared_ptr<Node> Parser::ReadNode()
@@ -54,6 +141,9 @@ namespace infofile
         const auto key_token = lexer->Peek();
         const auto has_key = key_token.type == TokenType::IDENT;
         const auto key = has_key ? ReadIdent() : "";
+        const auto key_end = lexer->last_end;
+        std::size_t value_begin = 0;
+        std::size_t value_end = 0;
         std::string value;
         if (has_key)
         {
@@ -64,7 +154,9 @@ namespace infofile
             }
             const auto has_value = lexer->Peek().type == TokenType::IDENT;
 
+            value_begin = lexer->Peek().begin;
             value = has_value ? ReadIdent() : "";
+            value_end = has_value ? lexer->last_end : value_begin;
 
             if (has_value && lexer->Peek().type == TokenType::ASSIGN)
             {
@@ -77,28 +169,37 @@ namespace infofile
         }
 
         auto node = std::make_shared<Node>(key, value);
+        CountNode(*node);
 
+        NodeSpans s;
         const auto next = lexer->Peek();
         switch (next.type)
         {
         case TokenType::ARRAY_BEGIN:
-            ParseArray(node);
-            return node;
         case TokenType::STRUCT_BEGIN:
-            ParseStruct(node);
-            return node;
+            s.body = ParseBody(node);
+            break;
         case TokenType::STRUCT_END:
-            return node;
         case TokenType::IDENT:
-            return node;
         case TokenType::SEP:
-            return node;
         case TokenType::ENDOFFILE:
-            return node;
+            break;
         default:
             lexer->ReportError(fmt::format("Invalid token {} in Node({} = {}), could either be [ or a {{", next.ValueForPrint(), PrintString(key), PrintString(value)));
+            return nullptr;
+        }
+
+        if (spans != nullptr)
+        {
+            s.node = {key_token.begin, std::max(key_token.begin, lexer->last_end)};
+            if (has_key)
+            {
+                s.name = {key_token.begin, key_end};
+                s.value = {value_begin, value_end};
+            }
+            spans->Add(node.get(), s);
         }
-        return nullptr;
+        return node;
     }
 
     std::shared_ptr<Node> Parser::ReadValue()
@@ -107,19 +208,32 @@ namespace infofile
         switch (next.type)
         {
         case TokenType::ARRAY_BEGIN:
+        case TokenType::STRUCT_BEGIN:
         {
             auto node = std::make_shared<Node>("", "");
-            ParseArray(node);
+            CountNode(*node);
+            NodeSpans s;
+            s.body = ParseBody(node);
+            if (spans != nullptr)
+            {
+                s.node = s.body;
+                spans->Add(node.get(), s);
+            }
             return node;
         }
-        case TokenType::STRUCT_BEGIN:
+        case TokenType::IDENT:
         {
-            auto node = std::make_shared<Node>("", "");
-            ParseStruct(node);
+            auto node = std::make_shared<Node>("", ReadIdent());
+            CountNode(*node);
+            if (spans != nullptr)
+            {
+                NodeSpans s;
+                s.node = {next.begin, lexer->last_end};
+                s.value = s.node;
+                spans->Add(node.get(), s);
+            }
             return node;
         }
-        case TokenType::IDENT:
-            return std::make_shared<Node>("", ReadIdent());
         default:
             lexer->ReportError(fmt::format("Invalid token {} in array value, could either be [ or a {{", next.ValueForPrint()));
             return nullptr;
@@ -150,13 +264,26 @@ namespace infofile
             ret << ident.value;
         }
 
-        return ret.str();
+        auto ident = ret.str();
+        if constexpr (PARSE_STATS_ENABLED)
+        {
+            if (stats != nullptr)
+            {
+                // once into the stream and once out of it
+                stats->string_bytes_copied += 2 * ident.size();
+            }
+        }
+        return ident;
     }
 
     void Parser::ParseArray(std::shared_ptr<Node> root)
     {
         auto start = lexer->Read();
         assert(start.type == TokenType::ARRAY_BEGIN);
+        if (containers != nullptr)
+        {
+            containers->emplace_back(root.get());
+        }
 
         while (!IsOneOf(lexer->Peek().type, {TokenType::ARRAY_END, TokenType::ENDOFFILE}))
         {
@@ -166,7 +293,7 @@ namespace infofile
                 return;
             }
 
-            root->children.emplace_back(node);
+            AddChild(root, node);
 
             if (lexer->Peek().type == TokenType::SEP)
             {
@@ -188,6 +315,10 @@ namespace infofile
     {
         auto start = lexer->Read();
         assert(start.type == TokenType::STRUCT_BEGIN);
+        if (containers != nullptr)
+        {
+            containers->emplace_back(root.get());
+        }
 
         ParseStructMembers(root);
 
@@ -211,7 +342,7 @@ namespace infofile
                 return;
             }
 
-            root->children.emplace_back(node);
+            AddChild(root, node);
 
             if (lexer->Peek().type == TokenType::SEP)
             {
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <vector>
@@ -8,6 +9,9 @@ namespace infofile
 {
     struct Lexer;
     struct Node;
+    struct ParseStats;
+    struct SourceSpans;
+    struct Span;
 
     struct Parser
     {
@@ -23,6 +27,31 @@ namespace infofile
         void ParseStruct(std::shared_ptr<Node> root);
         void ParseStructMembers(std::shared_ptr<Node> root);
 
+        /** Parse a [...] or {...} if there is one, returns where it was.
+        */
+        Span ParseBody(std::shared_ptr<Node> root);
+
+        void CountNode(const Node& node);
+        void AddChild(std::shared_ptr<Node> root, std::shared_ptr<Node> node);
+        void EnterBody();
+        void LeaveBody();
+
         Lexer* lexer;
+
+        /** If set, every node that has a {...} or [...] is added in the order the brackets appear.
+        */
+        std::vector<Node*>* containers;
+
+        /** If set, the source spans of every parsed node are recorded here.
+        */
+        SourceSpans* spans;
+
+        /** If set, the nodes and their strings are counted here, see parsestats.h.
+        */
+        ParseStats* stats;
+
+        /** How many [...] and {...} the parser is currently in.
+        */
+        std::size_t depth;
     };
 }
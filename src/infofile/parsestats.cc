@@ -0,0 +1,82 @@
+#include "infofile/parsestats.h"
+
+#include "fmt/core.h"
+
+namespace infofile
+{
+    namespace
+    {
+        const char* TokenTypeName(TokenType type)
+        {
+            switch (type)
+            {
+            case TokenType::STRUCT_BEGIN:
+                return "struct begin";
+            case TokenType::STRUCT_END:
+                return "struct end";
+            case TokenType::ARRAY_BEGIN:
+                return "array begin";
+            case TokenType::ARRAY_END:
+                return "array end";
+            case TokenType::SEP:
+                return "separator";
+            case TokenType::ASSIGN:
+                return "assign";
+            case TokenType::IDENT:
+                return "ident";
+            case TokenType::COMBINE:
+                return "combine";
+            case TokenType::UNKNOWN:
+                return "unknown";
+            case TokenType::ENDOFFILE:
+                return "end of file";
+            }
+            return "?";
+        }
+
+        double Milliseconds(std::chrono::nanoseconds time)
+        {
+            return std::chrono::duration<double, std::milli>(time).count();
+        }
+    }
+
+    std::size_t ParseStats::Tokens(TokenType type) const
+    {
+        return tokens[static_cast<std::size_t>(type)];
+    }
+
+    std::size_t ParseStats::TotalTokens() const
+    {
+        std::size_t total = 0;
+        for (const auto count : tokens)
+        {
+            total += count;
+        }
+        return total;
+    }
+
+    std::string PrintParseStats(const ParseStats& stats)
+    {
+        if (PARSE_STATS_ENABLED == false)
+        {
+            return "Parse stats are disabled in this build\n";
+        }
+
+        std::string ret;
+        ret += fmt::format("bytes: {}\n", stats.bytes);
+        ret += fmt::format("tokens: {}\n", stats.TotalTokens());
+        for (std::size_t i = 0; i < TOKEN_TYPE_COUNT; i += 1)
+        {
+            if (stats.tokens[i] != 0)
+            {
+                ret += fmt::format("  {}: {}\n", TokenTypeName(static_cast<TokenType>(i)), stats.tokens[i]);
+            }
+        }
+        ret += fmt::format("nodes: {}\n", stats.nodes);
+        ret += fmt::format("max depth: {}\n", stats.max_depth);
+        ret += fmt::format("string bytes: {} copied, {} referenced\n", stats.string_bytes_copied, stats.string_bytes_referenced);
+        ret += fmt::format("heap allocations: {}\n", stats.heap_allocations);
+        ret += fmt::format("time: {:.3f} ms lexing, {:.3f} ms parsing\n", Milliseconds(stats.lexing), Milliseconds(stats.parsing));
+        return ret;
+    }
+}
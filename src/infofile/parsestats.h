@@ -0,0 +1,56 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+#include "infofile/lexer.h"
+
+namespace infofile
+{
+    /** Define INFOFILE_NO_PARSE_STATS, or configure with INFOFILE_PARSE_STATS=OFF, to remove the counting from the parser.
+    A ParseStats passed to Parse or ReadFile is then left empty.
+    */
+#if defined(INFOFILE_NO_PARSE_STATS)
+    constexpr bool PARSE_STATS_ENABLED = false;
+#else
+    constexpr bool PARSE_STATS_ENABLED = true;
+#endif
+
+    constexpr std::size_t TOKEN_TYPE_COUNT = static_cast<std::size_t>(TokenType::ENDOFFILE) + 1;
+
+    /** What a parse did, to find out why a file is slow to load.
+    */
+    struct ParseStats
+    {
+        std::size_t bytes = 0;
+        std::array<std::size_t, TOKEN_TYPE_COUNT> tokens = {};
+        std::size_t nodes = 0;
+
+        /** The deepest nesting of {...} and [...].
+        */
+        std::size_t max_depth = 0;
+
+        /** The parser doesn't keep references to the source, every string is copied.
+        referenced is the size of the names and values that end up in the tree, and copied counts every copy on the way there.
+        */
+        std::size_t string_bytes_copied = 0;
+        std::size_t string_bytes_referenced = 0;
+
+        /** Allocations for the tree: the nodes, the strings that are too long for the small string buffer
+        and the growing of child lists. Temporary allocations in the lexer are not included.
+        */
+        std::size_t heap_allocations = 0;
+
+        /** Time spent reading tokens, and the rest of the parse.
+        */
+        std::chrono::nanoseconds lexing{0};
+        std::chrono::nanoseconds parsing{0};
+
+        std::size_t Tokens(TokenType type) const;
+        std::size_t TotalTokens() const;
+    };
+
+    std::string PrintParseStats(const ParseStats& stats);
+}
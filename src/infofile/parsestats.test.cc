@@ -0,0 +1,71 @@
+#include "catch.hpp"
+#include "catchy/stringeq.h"
+#include "infofile/infofile.h"
+#include "infofile/parsestats.h"
+
+using namespace infofile;
+
+TEST_CASE("parsestats", "[parsestats]")
+{
+    const std::string source = "a { b [1, 2] }";
+    std::vector<std::string> errors;
+    ParseStats stats;
+    auto root = Parse("inline", source, &errors, &stats);
+    CHECK(errors.empty());
+    REQUIRE(root != nullptr);
+
+    if (PARSE_STATS_ENABLED == false)
+    {
+        CHECK(stats.TotalTokens() == 0);
+        CHECK(stats.nodes == 0);
+        CHECK(catchy::StringEq(PrintParseStats(stats), "Parse stats are disabled in this build\n"));
+        return;
+    }
+
+    SECTION("counts")
+    {
+        CHECK(stats.bytes == source.size());
+        CHECK(stats.Tokens(TokenType::IDENT) == 4);
+        CHECK(stats.Tokens(TokenType::STRUCT_BEGIN) == 1);
+        CHECK(stats.Tokens(TokenType::STRUCT_END) == 1);
+        CHECK(stats.Tokens(TokenType::ARRAY_BEGIN) == 1);
+        CHECK(stats.Tokens(TokenType::ARRAY_END) == 1);
+        CHECK(stats.Tokens(TokenType::SEP) == 1);
+        CHECK(stats.Tokens(TokenType::ENDOFFILE) >= 1);
+        CHECK(stats.nodes == 5);
+        CHECK(stats.max_depth == 2);
+    }
+
+    SECTION("strings and allocations")
+    {
+        CHECK(stats.string_bytes_referenced == 4);
+        CHECK(stats.string_bytes_copied >= stats.string_bytes_referenced);
+        // every node and at least one child list
+        CHECK(stats.heap_allocations > stats.nodes);
+    }
+
+    SECTION("long strings are allocated")
+    {
+        ParseStats long_stats;
+        Parse("inline", "a 'a string that does not fit in the small string buffer'", &errors, &long_stats);
+        CHECK(errors.empty());
+        CHECK(long_stats.nodes == 2);
+        CHECK(long_stats.heap_allocations == 4);
+    }
+
+    SECTION("accumulates")
+    {
+        Parse("inline", source, &errors, &stats);
+        CHECK(stats.bytes == 2 * source.size());
+        CHECK(stats.nodes == 10);
+        CHECK(stats.max_depth == 2);
+    }
+
+    SECTION("print")
+    {
+        const auto printed = PrintParseStats(stats);
+        CHECK(printed.find("nodes: 5\n") != std::string::npos);
+        CHECK(printed.find("max depth: 2\n") != std::string::npos);
+        CHECK(printed.find("  ident: 4\n") != std::string::npos);
+    }
+}
@@ -0,0 +1,115 @@
+#include "infofile/persistent.h"
+
+#include <functional>
+#include <utility>
+
+namespace infofile
+{
+    namespace
+    {
+        using Update = std::function<PersistentTree(const PersistentNode&)>;
+
+        PersistentTree UpdatePath(const PersistentTree& node, const std::vector<std::size_t>& path, std::size_t depth, const Update& update)
+        {
+            if (depth == path.size())
+            {
+                return update(*node);
+            }
+
+            const auto index = path[depth];
+            if (index >= node->children.size())
+            {
+                return nullptr;
+            }
+
+            auto child = UpdatePath(node->children[index], path, depth + 1, update);
+            if (child == nullptr)
+            {
+                return nullptr;
+            }
+
+            auto children = node->children;
+            children[index] = std::move(child);
+            return std::make_shared<const PersistentNode>(node->name, node->value, std::move(children));
+        }
+    }
+
+    PersistentNode::PersistentNode(const std::string& n, const std::string& v, std::vector<PersistentTree> c)
+        : name(n)
+        , value(v)
+        , children(std::move(c))
+    {
+    }
+
+    PersistentTree Freeze(const Node& node)
+    {
+        std::vector<PersistentTree> children;
+        children.reserve(node.children.size());
+        for (const auto& child : node.children)
+        {
+            children.emplace_back(Freeze(*child));
+        }
+        return std::make_shared<const PersistentNode>(node.name, node.value, std::move(children));
+    }
+
+    std::shared_ptr<Node> Thaw(const PersistentNode& node)
+    {
+        auto thawed = std::make_shared<Node>(node.name, node.value);
+        thawed->children.reserve(node.children.size());
+        for (const auto& child : node.children)
+        {
+            thawed->children.emplace_back(Thaw(*child));
+        }
+        return thawed;
+    }
+
+    PersistentTree Find(const PersistentTree& root, const std::vector<std::size_t>& path)
+    {
+        auto node = root;
+        for (const auto index : path)
+        {
+            if (index >= node->children.size())
+            {
+                return nullptr;
+            }
+            node = node->children[index];
+        }
+        return node;
+    }
+
+    PersistentTree Replace(const PersistentTree& root, const std::vector<std::size_t>& path, PersistentTree node)
+    {
+        return UpdatePath(root, path, 0, [&node](const PersistentNode&) { return node; });
+    }
+
+    PersistentTree SetValue(const PersistentTree& root, const std::vector<std::size_t>& path, const std::string& value)
+    {
+        return UpdatePath(root, path, 0, [&value](const PersistentNode& old) { return std::make_shared<const PersistentNode>(old.name, value, old.children); });
+    }
+
+    PersistentTree InsertChild(const PersistentTree& root, const std::vector<std::size_t>& path, std::size_t index, PersistentTree child)
+    {
+        return UpdatePath(root, path, 0, [index, &child](const PersistentNode& old) -> PersistentTree {
+            if (index > old.children.size())
+            {
+                return nullptr;
+            }
+            auto children = old.children;
+            children.insert(children.begin() + static_cast<std::ptrdiff_t>(index), child);
+            return std::make_shared<const PersistentNode>(old.name, old.value, std::move(children));
+        });
+    }
+
+    PersistentTree RemoveChild(const PersistentTree& root, const std::vector<std::size_t>& path, std::size_t index)
+    {
+        return UpdatePath(root, path, 0, [index](const PersistentNode& old) -> PersistentTree {
+            if (index >= old.children.size())
+            {
+                return nullptr;
+            }
+            auto children = old.children;
+            children.erase(children.begin() + static_cast<std::ptrdiff_t>(index));
+            return std::make_shared<const PersistentNode>(old.name, old.value, std::move(children));
+        });
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "infofile/node.h"
+
+namespace infofile
+{
+    struct PersistentNode;
+
+    /** A persistent tree is only reached through const pointers, so it can be read from any number of threads
+    while updates create new versions that share everything but the changed path.
+    */
+    using PersistentTree = std::shared_ptr<const PersistentNode>;
+
+    struct PersistentNode
+    {
+        PersistentNode(const std::string& n, const std::string& v, std::vector<PersistentTree> c);
+
+        std::string name;
+        std::string value;
+        std::vector<PersistentTree> children;
+    };
+
+    PersistentTree Freeze(const Node& node);
+
+    /** Create a regular mutable copy of a persistent tree.
+    */
+    std::shared_ptr<Node> Thaw(const PersistentNode& node);
+
+    /** Follow the child indices from the root, returns null if the path doesn't exist.
+    */
+    PersistentTree Find(const PersistentTree& root, const std::vector<std::size_t>& path);
+
+    /** Updates copy the nodes from the root to the changed node and return the new root, the old root is unchanged.
+    They return null if the path or index doesn't exist.
+    */
+    PersistentTree Replace(const PersistentTree& root, const std::vector<std::size_t>& path, PersistentTree node);
+    PersistentTree SetValue(const PersistentTree& root, const std::vector<std::size_t>& path, const std::string& value);
+    PersistentTree InsertChild(const PersistentTree& root, const std::vector<std::size_t>& path, std::size_t index, PersistentTree child);
+    PersistentTree RemoveChild(const PersistentTree& root, const std::vector<std::size_t>& path, std::size_t index);
+}
@@ -0,0 +1,91 @@
+#include <thread>
+
+#include "catch.hpp"
+#include "catchy/stringeq.h"
+#include "infofile/infofile.h"
+#include "infofile/persistent.h"
+
+using namespace infofile;
+
+namespace
+{
+    std::string Print(const PersistentTree& tree)
+    {
+        return PrintToString(PrintOptions{}, Thaw(*tree));
+    }
+
+    std::string PrintInline(const std::string& src)
+    {
+        std::vector<std::string> errors;
+        return PrintToString(PrintOptions{}, Parse("inline", src, &errors));
+    }
+}
+
+TEST_CASE("persistent", "[persistent]")
+{
+    std::vector<std::string> errors;
+    const auto root = Freeze(*Parse("inline", "a { b 1; c 2 } d { e 3 }", &errors));
+    const auto original = Print(root);
+
+    SECTION("freeze and thaw")
+    {
+        CHECK(catchy::StringEq(original, PrintInline("a { b 1; c 2 } d { e 3 }")));
+    }
+
+    SECTION("set value")
+    {
+        const auto updated = SetValue(root, {0, 1}, "5");
+        REQUIRE(updated != nullptr);
+        CHECK(catchy::StringEq(Print(updated), PrintInline("a { b 1; c 5 } d { e 3 }")));
+        CHECK(catchy::StringEq(Print(root), original));
+
+        // only the path is copied
+        CHECK(updated->children[0] != root->children[0]);
+        CHECK(updated->children[0]->children[0] == root->children[0]->children[0]);
+        CHECK(updated->children[1] == root->children[1]);
+    }
+
+    SECTION("insert, remove and replace")
+    {
+        const auto inserted = InsertChild(root, {1}, 0, Find(root, {0, 0}));
+        REQUIRE(inserted != nullptr);
+        CHECK(catchy::StringEq(Print(inserted), PrintInline("a { b 1; c 2 } d { b 1; e 3 }")));
+
+        const auto removed = RemoveChild(inserted, {}, 0);
+        REQUIRE(removed != nullptr);
+        CHECK(catchy::StringEq(Print(removed), PrintInline("d { b 1; e 3 }")));
+
+        const auto replaced = Replace(root, {1}, Find(root, {0}));
+        REQUIRE(replaced != nullptr);
+        CHECK(catchy::StringEq(Print(replaced), PrintInline("a { b 1; c 2 } a { b 1; c 2 }")));
+
+        CHECK(catchy::StringEq(Print(root), original));
+    }
+
+    SECTION("missing path")
+    {
+        CHECK(Find(root, {2}) == nullptr);
+        CHECK(SetValue(root, {0, 2}, "x") == nullptr);
+        CHECK(InsertChild(root, {1}, 2, root) == nullptr);
+        CHECK(RemoveChild(root, {1}, 1) == nullptr);
+    }
+
+    SECTION("readers keep their version")
+    {
+        bool same = true;
+        auto reader = std::thread([root, original, &same]() {
+            for (int i = 0; i < 100; i += 1)
+            {
+                same = same && Print(root) == original;
+            }
+        });
+        auto tree = root;
+        for (int i = 0; i < 100; i += 1)
+        {
+            tree = SetValue(tree, {0, 0}, std::to_string(i));
+        }
+        reader.join();
+        CHECK(same);
+        CHECK(catchy::StringEq(Print(tree), PrintInline("a { b 99; c 2 } d { e 3 }")));
+    }
+}
@@ -0,0 +1,155 @@
+#include "infofile/prefetch.h"
+
+namespace infofile
+{
+    BlockQueue::BlockQueue(std::size_t mb)
+        : max_blocks(mb)
+        , closed(false)
+        , cancelled(false)
+    {
+    }
+
+    bool BlockQueue::Push(std::vector<char> block)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [this]() { return cancelled || closed || blocks.size() < max_blocks; });
+            if (cancelled || closed)
+            {
+                return false;
+            }
+            blocks.emplace_back(std::move(block));
+        }
+        changed.notify_all();
+        return true;
+    }
+
+    PushResult BlockQueue::TryPush(std::vector<char> block)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (cancelled || closed)
+            {
+                return PushResult::REFUSED;
+            }
+            if (blocks.size() >= max_blocks)
+            {
+                return PushResult::FULL;
+            }
+            blocks.emplace_back(std::move(block));
+        }
+        changed.notify_all();
+        return PushResult::PUSHED;
+    }
+
+    void BlockQueue::Close()
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            closed = true;
+        }
+        changed.notify_all();
+    }
+
+    bool BlockQueue::Pop(std::vector<char>* block)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [this]() { return closed || blocks.empty() == false; });
+            if (blocks.empty())
+            {
+                return false;
+            }
+            *block = std::move(blocks.front());
+            blocks.pop_front();
+        }
+        changed.notify_all();
+        return true;
+    }
+
+    void BlockQueue::Cancel()
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cancelled = true;
+        }
+        changed.notify_all();
+    }
+
+    void BlockQueue::Recycle(std::vector<char> block)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (recycled.size() < max_blocks)
+        {
+            recycled.emplace_back(std::move(block));
+        }
+    }
+
+    bool BlockQueue::TakeRecycled(std::vector<char>* block)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (recycled.empty())
+        {
+            return false;
+        }
+        *block = std::move(recycled.back());
+        recycled.pop_back();
+        return true;
+    }
+
+    QueueReader::QueueReader(const std::string& fn, BlockQueue* q)
+        : File(fn)
+        , queue(q)
+        , block_index(0)
+    {
+    }
+
+    char QueueReader::DoRead()
+    {
+        while (block_index >= block.size())
+        {
+            block_index = 0;
+            if (block.capacity() > 0)
+            {
+                queue->Recycle(std::move(block));
+            }
+            if (queue->Pop(&block) == false)
+            {
+                block.clear();
+                return 0;
+            }
+        }
+
+        const auto c = block[block_index];
+        block_index += 1;
+        return c;
+    }
+
+    PrefetchReader::PrefetchReader(const std::string& fn, std::size_t block_size, std::size_t block_count)
+        : QueueReader(fn, &blocks)
+        , blocks(block_count)
+    {
+        thread = std::thread([this, fn, block_size]() {
+            std::ifstream stream(fn, std::ios::binary);
+            while (stream.good())
+            {
+                std::vector<char> data;
+                blocks.TakeRecycled(&data);
+                data.resize(block_size);
+                stream.read(data.data(), static_cast<std::streamsize>(data.size()));
+                data.resize(static_cast<std::size_t>(stream.gcount()));
+                if (data.empty() == false && blocks.Push(std::move(data)) == false)
+                {
+                    break;
+                }
+            }
+            blocks.Close();
+        });
+    }
+
+    PrefetchReader::~PrefetchReader()
+    {
+        blocks.Cancel();
+        thread.join();
+    }
+}
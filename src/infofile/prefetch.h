@@ -0,0 +1,100 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "infofile/file.h"
+
+namespace infofile
+{
+    enum class PushResult
+    {
+        PUSHED,
+        FULL,  // the block was dropped, try again when the reader has caught up
+        REFUSED  // the queue was closed or cancelled
+    };
+
+    /** A bounded queue of data blocks going from a producer to a reader.
+    */
+    struct BlockQueue
+    {
+        explicit BlockQueue(std::size_t max_blocks);
+
+        /** Add a block, waits if the queue is full.
+        Returns false if the reader has cancelled and no more data is wanted, or if the queue was closed.
+        */
+        bool Push(std::vector<char> block);
+
+        /** Add a block if there is room, never waits.
+        */
+        PushResult TryPush(std::vector<char> block);
+
+        /** The producer is done, no more blocks will be pushed.
+        */
+        void Close();
+
+        /** Get the next block, waits until one is available.
+        Returns false when the queue is closed and empty.
+        */
+        bool Pop(std::vector<char>* block);
+
+        /** The reader is done, wakes up and fails a waiting producer.
+        */
+        void Cancel();
+
+        /** The reader is done with a block, keeps it so the producer can fill it again instead of allocating a new one.
+        At most max_blocks blocks are kept.
+        */
+        void Recycle(std::vector<char> block);
+
+        /** Get a block the reader is done with, never waits.
+        Returns false if there is none.
+        */
+        bool TakeRecycled(std::vector<char>* block);
+
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::deque<std::vector<char>> blocks;
+        std::vector<std::vector<char>> recycled;
+        std::size_t max_blocks;
+        bool closed;
+        bool cancelled;
+    };
+
+    /** Reads the blocks of a queue as a file.
+    */
+    struct QueueReader : public File
+    {
+        QueueReader(const std::string& fn, BlockQueue* q);
+
+        char DoRead() override;
+
+        BlockQueue* queue;
+        std::vector<char> block;
+        std::size_t block_index;
+    };
+
+    /** Reads a file on a background thread in large blocks, so the lexer can work on one block while the next is read.
+    Useful for pipes and slow disks.
+    */
+    struct PrefetchReader : public QueueReader
+    {
+        static constexpr std::size_t DEFAULT_BLOCK_SIZE = 1024 * 1024;
+        static constexpr std::size_t DEFAULT_BLOCK_COUNT = 2;
+
+        explicit PrefetchReader(const std::string& fn, std::size_t block_size = DEFAULT_BLOCK_SIZE, std::size_t block_count = DEFAULT_BLOCK_COUNT);
+        ~PrefetchReader() override;
+
+        PrefetchReader(const PrefetchReader&) = delete;
+        void operator=(const PrefetchReader&) = delete;
+
+        BlockQueue blocks;
+        std::thread thread;
+    };
+}
@@ -0,0 +1,157 @@
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+#include "catch.hpp"
+#include "catchy/stringeq.h"
+#include "infofile/infofile.h"
+#include "infofile/lexer.h"
+#include "infofile/parser.h"
+#include "infofile/prefetch.h"
+
+using namespace infofile;
+
+namespace
+{
+    std::vector<char> Block(const std::string& str)
+    {
+        return {str.begin(), str.end()};
+    }
+}
+
+TEST_CASE("queue reader reads all blocks", "[prefetch]")
+{
+    BlockQueue queue{2};
+    std::thread producer([&queue]() {
+        queue.Push(Block("ab"));
+        queue.Push(Block(""));
+        queue.Push(Block("c"));
+        queue.Push(Block("de"));
+        queue.Close();
+    });
+
+    QueueReader reader{"inline", &queue};
+    std::string read;
+    for (char c = reader.Read(); c != 0; c = reader.Read())
+    {
+        read += c;
+    }
+    producer.join();
+
+    CHECK(catchy::StringEq(read, "abcde"));
+}
+
+TEST_CASE("queue reader recycles read blocks", "[prefetch]")
+{
+    BlockQueue queue{2};
+    queue.Push(Block("ab"));
+    queue.Push(Block("c"));
+    const auto* first = queue.blocks.front().data();
+    queue.Close();
+
+    QueueReader reader{"inline", &queue};
+    CHECK(reader.Read() == 'a');
+    CHECK(reader.Read() == 'b');
+    CHECK(reader.Read() == 'c');
+    CHECK(reader.Read() == 0);
+
+    REQUIRE(queue.recycled.size() == 2);
+    std::vector<char> block;
+    CHECK(queue.TakeRecycled(&block));
+    CHECK(queue.TakeRecycled(&block));
+    CHECK(block.data() == first);
+    CHECK_FALSE(queue.TakeRecycled(&block));
+}
+
+TEST_CASE("queue keeps at most max blocks for recycling", "[prefetch]")
+{
+    BlockQueue queue{1};
+    queue.Recycle(Block("a"));
+    queue.Recycle(Block("b"));
+    CHECK(queue.recycled.size() == 1);
+}
+
+TEST_CASE("cancelled queue stops the producer", "[prefetch]")
+{
+    BlockQueue queue{1};
+    CHECK(queue.Push(Block("a")));
+    queue.Cancel();
+    CHECK_FALSE(queue.Push(Block("b")));
+}
+
+TEST_CASE("closed queue refuses more blocks", "[prefetch]")
+{
+    BlockQueue queue{2};
+    CHECK(queue.Push(Block("a")));
+    queue.Close();
+    CHECK_FALSE(queue.Push(Block("b")));
+
+    std::vector<char> block;
+    CHECK(queue.Pop(&block));
+    CHECK_FALSE(queue.Pop(&block));
+}
+
+TEST_CASE("try push never waits", "[prefetch]")
+{
+    BlockQueue queue{1};
+    CHECK(queue.TryPush(Block("a")) == PushResult::PUSHED);
+    CHECK(queue.TryPush(Block("b")) == PushResult::FULL);
+
+    std::vector<char> block;
+    CHECK(queue.Pop(&block));
+    CHECK(catchy::StringEq(std::string(block.begin(), block.end()), "a"));
+    CHECK(queue.TryPush(Block("c")) == PushResult::PUSHED);
+
+    queue.Close();
+    CHECK(queue.TryPush(Block("d")) == PushResult::REFUSED);
+}
+
+TEST_CASE("prefetch reader parses same as parse", "[prefetch]")
+{
+    const std::string src = "key1 value1 // comment\nkey2 \"value 2\" { a b; c [1 2 3] }\nkey3 <<EOF\nsome\ndata\nEOF\n$";
+    const auto path = (std::filesystem::temp_directory_path() / "infofile_test_prefetch.info").string();
+    {
+        std::ofstream f{path, std::ios::binary};
+        f << src;
+    }
+
+    std::vector<std::string> expected_errors;
+    const auto expected = Parse(path, src, &expected_errors);
+
+    SECTION("tiny blocks")
+    {
+        // so tokens span several blocks
+        auto reader = PrefetchReader{path, 3, 2};
+        std::vector<std::string> errors;
+        auto lexer = Lexer{&reader, &errors};
+        auto parser = Parser{&lexer};
+        const auto parsed = parser.ReadRootNode();
+        CHECK(TokenType::ENDOFFILE != lexer.Peek().type);
+
+        CHECK(catchy::StringEq(PrintToString(PrintOptions{}, parsed), PrintToString(PrintOptions{}, expected)));
+        CHECK(errors.size() + 1 == expected_errors.size());
+    }
+
+    std::vector<std::string> read_errors;
+    const auto read = ReadFilePrefetched(path, &read_errors);
+    CHECK(catchy::StringEq(read_errors, expected_errors));
+    CHECK(catchy::StringEq(PrintToString(PrintOptions{}, read), PrintToString(PrintOptions{}, expected)));
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("prefetch reader can stop early", "[prefetch]")
+{
+    const auto path = (std::filesystem::temp_directory_path() / "infofile_test_prefetch_early.info").string();
+    {
+        std::ofstream f{path, std::ios::binary};
+        f << std::string(1000, 'a');
+    }
+
+    {
+        auto reader = PrefetchReader{path, 10, 1};
+        CHECK('a' == reader.Read());
+    }
+
+    std::filesystem::remove(path);
+}
@@ -0,0 +1,120 @@
+#include "infofile/printbuffer.h"
+
+#include <cerrno>
+
+#include "infofile/printstring.h"
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace infofile
+{
+    PrintBuffer::PrintBuffer(PrintSink s, std::size_t bs)
+        : sink(std::move(s))
+        , block_size(bs)
+        , failed(false)
+    {
+        buffer.reserve(block_size);
+    }
+
+    PrintBuffer::~PrintBuffer()
+    {
+        Flush();
+    }
+
+    void PrintBuffer::Write(std::string_view text)
+    {
+        buffer.append(text.data(), text.size());
+        if (buffer.size() >= block_size)
+        {
+            Flush();
+        }
+    }
+
+    void PrintBuffer::Write(char c)
+    {
+        buffer.push_back(c);
+        if (buffer.size() >= block_size)
+        {
+            Flush();
+        }
+    }
+
+    void PrintBuffer::WriteString(std::string_view str)
+    {
+        PrintString(&buffer, str);
+        if (buffer.size() >= block_size)
+        {
+            Flush();
+        }
+    }
+
+    void PrintBuffer::WriteBlock(std::string_view block)
+    {
+        Flush();
+        if (failed == false && block.empty() == false)
+        {
+            failed = sink(block) == false;
+        }
+    }
+
+    bool PrintBuffer::Flush()
+    {
+        if (failed == false && buffer.empty() == false)
+        {
+            failed = sink(buffer) == false;
+        }
+        buffer.clear();
+        return failed == false;
+    }
+
+    PrintSink FileDescriptorSink(int fd)
+    {
+        return [fd](std::string_view text) {
+            while (text.empty() == false)
+            {
+#if defined(_WIN32)
+                const auto written = _write(fd, text.data(), static_cast<unsigned int>(text.size()));
+#else
+                const auto written = write(fd, text.data(), text.size());
+#endif
+                if (written < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+                if (written <= 0)
+                {
+                    return false;
+                }
+                text.remove_prefix(static_cast<std::size_t>(written));
+            }
+            return true;
+        };
+    }
+
+    PrintSink StringSink(std::string* out)
+    {
+        return [out](std::string_view text) {
+            out->append(text.data(), text.size());
+            return true;
+        };
+    }
+
+    IndentCache::IndentCache(const std::string& t)
+        : tab(t)
+    {
+    }
+
+    std::string_view IndentCache::Get(std::size_t depth)
+    {
+        const auto size = depth * tab.size();
+        while (indents.size() < size)
+        {
+            indents += tab;
+        }
+        return std::string_view{indents}.substr(0, size);
+    }
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace infofile
+{
+    /** Receives printed text in large blocks, returns false if the text couldn't be written.
+    */
+    using PrintSink = std::function<bool(std::string_view text)>;
+
+    /** Collects printed text in one growing buffer and passes it on to a sink in large blocks.
+    */
+    struct PrintBuffer
+    {
+        static constexpr std::size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+        explicit PrintBuffer(PrintSink s, std::size_t block_size = DEFAULT_BLOCK_SIZE);
+
+        /** Flushes what is left.
+        */
+        ~PrintBuffer();
+
+        PrintBuffer(const PrintBuffer&) = delete;
+        void operator=(const PrintBuffer&) = delete;
+
+        void Write(std::string_view text);
+        void Write(char c);
+
+        /** Write a name or value, quoted and escaped if needed like PrintString.
+        */
+        void WriteString(std::string_view str);
+
+        /** Flush and pass a large block straight to the sink without copying it.
+        */
+        void WriteBlock(std::string_view block);
+
+        /** Pass everything written so far to the sink, returns false if the sink has failed.
+        Once the sink has failed nothing more is passed to it.
+        */
+        bool Flush();
+
+        PrintSink sink;
+        std::string buffer;
+        std::size_t block_size;
+        bool failed;
+    };
+
+    /** Write to a file descriptor such as 1 for stdout, the descriptor is not closed.
+    */
+    PrintSink FileDescriptorSink(int fd);
+
+    /** Append to a string that must outlive the sink.
+    */
+    PrintSink StringSink(std::string* out);
+
+    /** Repeats of a indentation string, so printing a line doesn't need to build it.
+    */
+    struct IndentCache
+    {
+        explicit IndentCache(const std::string& t);
+
+        /** The view is valid until it's called with a deeper depth.
+        */
+        std::string_view Get(std::size_t depth);
+
+        std::string tab;
+        std::string indents;
+    };
+}
@@ -0,0 +1,140 @@
+#include <cstdio>
+
+#include "catch.hpp"
+#include "fmt/core.h"
+#include "catchy/stringeq.h"
+#include "infofile/infofile.h"
+#include "infofile/printbuffer.h"
+
+using namespace infofile;
+
+TEST_CASE("print buffer", "[printbuffer]")
+{
+    SECTION("blocks")
+    {
+        std::vector<std::string> blocks;
+        {
+            PrintBuffer buffer{[&blocks](std::string_view text) {
+                                   blocks.emplace_back(text);
+                                   return true;
+                               },
+                               4};
+            buffer.Write("ab");
+            buffer.Write('c');
+            CHECK(blocks.empty());
+            buffer.Write("defgh");
+            buffer.Write('i');
+        }
+        CHECK(blocks == std::vector<std::string>{"abcdefgh", "i"});
+    }
+
+    SECTION("failed sink")
+    {
+        int calls = 0;
+        PrintBuffer buffer{[&calls](std::string_view) {
+                               calls += 1;
+                               return false;
+                           },
+                           2};
+        buffer.Write("abc");
+        buffer.Write("def");
+        CHECK_FALSE(buffer.Flush());
+        CHECK(1 == calls);
+    }
+
+    SECTION("indent cache")
+    {
+        IndentCache indents{"ab"};
+        CHECK(catchy::StringEq(std::string{indents.Get(0)}, ""));
+        CHECK(catchy::StringEq(std::string{indents.Get(3)}, "ababab"));
+        CHECK(catchy::StringEq(std::string{indents.Get(1)}, "ab"));
+    }
+}
+
+TEST_CASE("print buffered", "[printbuffer]")
+{
+    std::vector<std::string> errors;
+    const auto root = Parse("inline", "a { b c; d [1, 2, \"x y\"] } e f", &errors);
+    PrintOptions options;
+    options.tab = "\t";
+    const auto expected = PrintToString(options, root);
+    CHECK(catchy::StringEq(expected, "\"\" \"\" {\n\ta \"\" {\n\t\tb c;\n\t\td \"\" {\n\t\t\t\"\" \"1\";\n\t\t\t\"\" \"2\";\n\t\t\t\"\" \"x y\";\n\t\t};\n\t};\n\te f;\n};\n"));
+
+    SECTION("small blocks")
+    {
+        std::string printed;
+        {
+            PrintBuffer buffer{StringSink(&printed), 3};
+            PrintBuffered(&buffer, options, *root);
+        }
+        CHECK(catchy::StringEq(printed, expected));
+    }
+
+#if !defined(_WIN32)
+    SECTION("file descriptor")
+    {
+        auto* file = std::tmpfile();
+        REQUIRE(file != nullptr);
+        CHECK(PrintToFileDescriptor(options, root, fileno(file)));
+        std::rewind(file);
+        std::string printed(expected.size() + 1, '\0');
+        printed.resize(std::fread(&printed[0], 1, printed.size(), file));
+        std::fclose(file);
+        CHECK(catchy::StringEq(printed, expected));
+    }
+#endif
+}
+
+TEST_CASE("print parallel", "[printbuffer]")
+{
+    std::string source;
+    for (int i = 0; i < 300; i += 1)
+    {
+        source += fmt::format("node{} \"value {}\" {{ a {}; b [1, 2, {{ c d }}] }}\n", i, i, i);
+    }
+    std::vector<std::string> errors;
+    const auto root = Parse("inline", source, &errors);
+    REQUIRE(errors.empty());
+    const PrintOptions po;
+    const auto expected = PrintToString(po, root);
+
+    for (const std::size_t threads : {1u, 2u, 3u, 8u})
+    {
+        ParallelPrintOptions options;
+        options.threads = threads;
+        CHECK(catchy::StringEq(PrintToStringParallel(po, root, options), expected));
+
+        std::string printed;
+        {
+            PrintBuffer buffer{StringSink(&printed), 7};
+            PrintParallel(&buffer, po, *root, options);
+        }
+        CHECK(catchy::StringEq(printed, expected));
+    }
+
+    SECTION("small root")
+    {
+        const auto small = Parse("inline", "a b; c d", &errors);
+        ParallelPrintOptions options;
+        options.threads = 4;
+        options.min_children = 0;
+        CHECK(catchy::StringEq(PrintToStringParallel(po, small, options), PrintToString(po, small)));
+        CHECK(catchy::StringEq(PrintToStringParallel(po, std::make_shared<Node>(), options), PrintToString(po, std::make_shared<Node>())));
+    }
+
+#if !defined(_WIN32)
+    SECTION("file descriptor")
+    {
+        auto* file = std::tmpfile();
+        REQUIRE(file != nullptr);
+        ParallelPrintOptions options;
+        options.threads = 4;
+        CHECK(PrintToFileDescriptorParallel(po, root, fileno(file), options));
+        std::rewind(file);
+        std::string printed(expected.size() + 1, '\0');
+        printed.resize(std::fread(&printed[0], 1, printed.size(), file));
+        std::fclose(file);
+        CHECK(catchy::StringEq(printed, expected));
+    }
+#endif
+}
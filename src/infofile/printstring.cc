@@ -1,36 +1,55 @@
 #include "infofile/printstring.h"
 
-#include <sstream>
+#include <array>
+#include <cstdint>
+#include <cstring>
 
-#include "fmt/core.h"
 #include "infofile/chars.h"
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define INFOFILE_SSE2 1
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
 namespace infofile
 {
     namespace
     {
-        bool IsIdent(const std::string& str)
+        std::array<bool, 256> MakeIdentTable()
         {
-            if (str.empty())
+            std::array<bool, 256> table = {};
+            for (std::size_t i = 0; i < table.size(); i += 1)
             {
-                return false;
+                table[i] = IsIdentChar(static_cast<char>(i), false);
             }
+            return table;
+        }
+
+        const std::array<bool, 256> IDENT_CHARS = MakeIdentTable();
 
-            bool first = true;
+        bool IsIdent(std::string_view str)
+        {
+            if (str.empty() || IsIdentChar(str[0], true) == false)
+            {
+                return false;
+            }
 
-            for (char c : str)
+            for (const char c : str)
             {
-                if (IsIdentChar(c, first) == false)
+                if (IDENT_CHARS[static_cast<unsigned char>(c)] == false)
                 {
                     return false;
                 }
-                first = false;
             }
 
             return true;
         }
 
-        std::string CharToCharInString(char c)
+        const char* EscapeForChar(char c)
         {
             switch (c)
             {
@@ -47,28 +66,113 @@ namespace infofile
             case '\\':
                 return "\\\\";
             default:
-                return fmt::format("{}", c);
+                return nullptr;
             }
         }
+
+        // quotes, backslashes and control characters up to \r may need escaping
+        bool MayNeedEscape(char c)
+        {
+            return c == '"' || c == '\\' || static_cast<unsigned char>(c) <= '\r';
+        }
+
+#if defined(INFOFILE_SSE2)
+        unsigned FirstBit(unsigned mask)
+        {
+#if defined(_MSC_VER)
+            unsigned long index = 0;
+            _BitScanForward(&index, mask);
+            return index;
+#else
+            return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+        }
+#endif
+
+        /** The position of the first character that may need escaping, 16 bytes at a time when possible.
+        */
+        std::size_t FindEscapeCandidate(const char* data, std::size_t size, std::size_t position)
+        {
+#if defined(INFOFILE_SSE2)
+            const auto quote = _mm_set1_epi8('"');
+            const auto backslash = _mm_set1_epi8('\\');
+            const auto control = _mm_set1_epi8('\r');
+            while (position + 16 <= size)
+            {
+                const auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + position));
+                const auto is_control = _mm_cmpeq_epi8(_mm_min_epu8(chunk, control), chunk);
+                const auto candidates = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)), is_control);
+                const auto mask = static_cast<unsigned>(_mm_movemask_epi8(candidates));
+                if (mask != 0)
+                {
+                    return position + FirstBit(mask);
+                }
+                position += 16;
+            }
+#else
+            // check 8 bytes at a time for a zero byte after masking or xoring with the special characters
+            constexpr std::uint64_t ONES = 0x0101010101010101ull;
+            constexpr std::uint64_t HIGHS = 0x8080808080808080ull;
+            const auto has_zero = [](std::uint64_t word) { return ((word - ONES) & ~word & HIGHS) != 0; };
+            while (position + 8 <= size)
+            {
+                std::uint64_t word = 0;
+                std::memcpy(&word, data + position, sizeof(word));
+                const auto below_16 = has_zero(word & 0xF0F0F0F0F0F0F0F0ull);
+                const auto quote = has_zero(word ^ (ONES * static_cast<unsigned char>('"')));
+                const auto backslash = has_zero(word ^ (ONES * static_cast<unsigned char>('\\')));
+                if (below_16 || quote || backslash)
+                {
+                    break;
+                }
+                position += 8;
+            }
+#endif
+            while (position < size && MayNeedEscape(data[position]) == false)
+            {
+                position += 1;
+            }
+            return position;
+        }
     }
 
-    std::string PrintString(const std::string& str)
+    void PrintString(std::string* out, std::string_view str)
     {
         if (IsIdent(str))
         {
-            return str;
+            out->append(str.data(), str.size());
+            return;
         }
-        else
+
+        out->push_back('"');
+        std::size_t position = 0;
+        while (position < str.size())
         {
-            std::ostringstream ss;
-            ss << "\"";
-            for (std::size_t i = 0; i < str.size(); i += 1)
+            const auto special = FindEscapeCandidate(str.data(), str.size(), position);
+            out->append(str.data() + position, special - position);
+            if (special == str.size())
             {
-                const char c = str[i];
-                ss << CharToCharInString(c);
+                break;
             }
-            ss << "\"";
-            return ss.str();
+
+            const auto* escape = EscapeForChar(str[special]);
+            if (escape != nullptr)
+            {
+                out->append(escape);
+            }
+            else
+            {
+                out->push_back(str[special]);
+            }
+            position = special + 1;
         }
+        out->push_back('"');
+    }
+
+    std::string PrintString(const std::string& str)
+    {
+        std::string printed;
+        PrintString(&printed, str);
+        return printed;
     }
-}
\ No newline at end of file
+}
@@ -1,8 +1,13 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 
 namespace infofile
 {
     std::string PrintString(const std::string& str);
+
+    /** Like PrintString but appends to out, without any temporary strings.
+    */
+    void PrintString(std::string* out, std::string_view str);
 }
@@ -54,3 +54,43 @@ TEST_CASE("print string tests", "[printstring]")
         REQUIRE(catchy::StringEq(PrintString("hello@hotmale.com"), "hello@hotmale.com"));
     }
 }
+
+TEST_CASE("print string long", "[printstring]")
+{
+    SECTION("clean runs")
+    {
+        const std::string text = "The quick brown fox jumps over the lazy dog, again and again";
+        REQUIRE(catchy::StringEq(PrintString(text), "\"" + text + "\""));
+    }
+
+    SECTION("escapes in every position")
+    {
+        const std::string clean = "abcdefghijklmnopqrstuvwxyz0123456789 ";
+        for (std::size_t i = 0; i < clean.size(); i += 1)
+        {
+            auto text = clean;
+            text[i] = '\n';
+            auto expected = clean;
+            expected.replace(i, 1, "\\n");
+            CHECK(catchy::StringEq(PrintString(text), "\"" + expected + "\""));
+        }
+    }
+
+    SECTION("other control characters are kept")
+    {
+        REQUIRE(catchy::StringEq(PrintString(std::string("0123456789abcdef\x01\x0e\x0f\x7f\x80\xff", 22)), std::string("\"0123456789abcdef\x01\x0e\x0f\x7f\x80\xff\"", 24)));
+    }
+
+    SECTION("null")
+    {
+        REQUIRE(catchy::StringEq(PrintString(std::string("0123456789abcdefg\0h", 19)), "\"0123456789abcdefg\\0h\""));
+    }
+
+    SECTION("append")
+    {
+        std::string out = "x ";
+        PrintString(&out, "a b");
+        PrintString(&out, "cd");
+        REQUIRE(catchy::StringEq(out, "x \"a b\"cd"));
+    }
+}
@@ -45,4 +45,23 @@ namespace infofile
     {
         return PleaseRead(stream);
     }
-}
\ No newline at end of file
+
+    MemoryReader::MemoryReader(const std::string& fn, const char* d, std::size_t s)
+        : File(fn)
+        , data(d)
+        , size(s)
+        , index(0)
+    {
+    }
+
+    char MemoryReader::DoRead()
+    {
+        if (index >= size)
+        {
+            return 0;
+        }
+        const auto c = data[index];
+        index += 1;
+        return c;
+    }
+}
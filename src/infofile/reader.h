@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <fstream>
 #include <sstream>
 #include <string>
@@ -25,4 +26,17 @@ namespace infofile
 
         char DoRead() override;
     };
+
+    /** Reads from a buffer owned by someone else, the buffer must outlive the reader.
+    */
+    struct MemoryReader : public File
+    {
+        const char* data;
+        std::size_t size;
+        std::size_t index;
+
+        MemoryReader(const std::string& fn, const char* d, std::size_t s);
+
+        char DoRead() override;
+    };
 }
\ No newline at end of file
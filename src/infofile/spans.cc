@@ -0,0 +1,137 @@
+#include "infofile/spans.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "fmt/core.h"
+#include "infofile/lexer.h"
+#include "infofile/parser.h"
+#include "infofile/reader.h"
+
+namespace infofile
+{
+    namespace
+    {
+        bool IsBefore(const PackedSpans& lhs, const PackedSpans& rhs)
+        {
+            return std::less<const Node*>{}(lhs.node, rhs.node);
+        }
+
+        std::uint32_t Pack(std::size_t value)
+        {
+            return static_cast<std::uint32_t>(value);
+        }
+
+        Span Unpack(std::size_t begin, std::uint32_t offset, std::uint32_t size)
+        {
+            return {begin + offset, begin + offset + size};
+        }
+    }
+
+    bool Span::IsEmpty() const
+    {
+        return begin == end;
+    }
+
+    std::size_t Span::Size() const
+    {
+        return end - begin;
+    }
+
+    void SourceSpans::Add(const Node* node, const NodeSpans& spans)
+    {
+        if (spans.node.end > std::numeric_limits<std::uint32_t>::max())
+        {
+            return;
+        }
+
+        const auto begin = spans.node.begin;
+        const auto relative = [begin](const Span& span) { return span.IsEmpty() ? 0 : Pack(span.begin - begin); };
+        nodes.emplace_back(PackedSpans{
+            node,
+            Pack(begin),
+            Pack(spans.node.Size()),
+            Pack(spans.name.Size()),
+            relative(spans.value),
+            Pack(spans.value.Size()),
+            relative(spans.body),
+            Pack(spans.body.Size())});
+    }
+
+    void SourceSpans::Sort()
+    {
+        std::sort(nodes.begin(), nodes.end(), IsBefore);
+    }
+
+    std::optional<NodeSpans> SourceSpans::Find(const Node& node) const
+    {
+        auto key = PackedSpans{};
+        key.node = &node;
+        const auto found = std::lower_bound(nodes.begin(), nodes.end(), key, IsBefore);
+        if (found == nodes.end() || found->node != &node)
+        {
+            return std::nullopt;
+        }
+
+        NodeSpans ret;
+        ret.node = Unpack(found->begin, 0, found->size);
+        ret.name = Unpack(found->begin, 0, found->name_size);
+        ret.value = Unpack(found->begin, found->value_offset, found->value_size);
+        ret.body = Unpack(found->begin, found->body_offset, found->body_size);
+        return ret;
+    }
+
+    std::shared_ptr<Node> ParseWithSpans(const std::string& filename, const std::string& data, std::vector<std::string>* errors, SourceSpans* spans)
+    {
+        spans->root = nullptr;
+        spans->nodes.clear();
+
+        auto reader = MemoryReader{filename, data.data(), data.size()};
+        auto lexer = Lexer(&reader, errors);
+        auto parser = Parser(&lexer);
+        parser.spans = spans;
+        auto parsed = parser.ReadRootNode();
+        ExpectEof(&lexer);
+        spans->Sort();
+        return parsed;
+    }
+
+    SourcePosition FindPosition(std::string_view source, std::size_t offset)
+    {
+        offset = std::min(offset, source.size());
+        int line = 1;
+        std::size_t line_start = 0;
+        const char* data = source.data();
+        while (const auto* newline = static_cast<const char*>(std::memchr(data + line_start, '\n', offset - line_start)))
+        {
+            line += 1;
+            line_start = static_cast<std::size_t>(newline - data) + 1;
+        }
+        return {line, static_cast<int>(offset - line_start) + 1};
+    }
+
+    LineIndex::LineIndex(std::string_view source)
+        : starts{0}
+    {
+        for (std::size_t i = 0; i < source.size(); i += 1)
+        {
+            if (source[i] == '\n')
+            {
+                starts.emplace_back(i + 1);
+            }
+        }
+    }
+
+    SourcePosition LineIndex::Find(std::size_t offset) const
+    {
+        const auto after = std::upper_bound(starts.begin(), starts.end(), offset);
+        const auto line = static_cast<std::size_t>(after - starts.begin());
+        return {static_cast<int>(line), static_cast<int>(offset - starts[line - 1]) + 1};
+    }
+
+    std::string ErrorAt(const std::string& filename, const SourcePosition& position, const std::string& error)
+    {
+        return fmt::format("{}({}:{}): {}", filename, position.line, position.column, error);
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "infofile/node.h"
+
+namespace infofile
+{
+    /** Byte offsets into the parsed source, end is one past the last character.
+    */
+    struct Span
+    {
+        std::size_t begin = 0;
+        std::size_t end = 0;
+
+        bool IsEmpty() const;
+        std::size_t Size() const;
+    };
+
+    struct NodeSpans
+    {
+        /** Everything from the first token of the node to the last, not including a trailing separator.
+        */
+        Span node;
+
+        /** The name and value including quotes and combined parts, empty if missing.
+        Nodes in arrays have no name and the value is the whole node.
+        */
+        Span name;
+        Span value;
+
+        /** The {...} or [...] including the brackets, empty for leafs and a root without braces.
+        */
+        Span body;
+    };
+
+    /** NodeSpans as they are stored, the name always starts the node and the value and body are stored relative to it.
+    */
+    struct PackedSpans
+    {
+        const Node* node;
+        std::uint32_t begin;
+        std::uint32_t size;
+        std::uint32_t name_size;
+        std::uint32_t value_offset;
+        std::uint32_t value_size;
+        std::uint32_t body_offset;
+        std::uint32_t body_size;
+    };
+
+    /** Where each node of a parsed tree came from, kept next to the tree so the nodes don't grow.
+    Offsets are stored in 32 bits so nodes in sources larger than 4 GiB have no spans.
+    */
+    struct SourceSpans
+    {
+        const Node* root = nullptr;
+
+        /** Sorted by node after parsing.
+        */
+        std::vector<PackedSpans> nodes;
+
+        void Add(const Node* node, const NodeSpans& spans);
+        void Sort();
+
+        /** Returns nothing if the node isn't part of the parsed tree.
+        */
+        std::optional<NodeSpans> Find(const Node& node) const;
+    };
+
+    /** Parse like Parse and record where every node is in data.
+    */
+    std::shared_ptr<Node> ParseWithSpans(const std::string& filename, const std::string& data, std::vector<std::string>* errors, SourceSpans* spans);
+
+    /** A position like in the parse errors, both starting at 1 and the column counted in bytes.
+    */
+    struct SourcePosition
+    {
+        int line;
+        int column;
+    };
+
+    /** Count the lines up to offset, for looking up a single position.
+    */
+    SourcePosition FindPosition(std::string_view source, std::size_t offset);
+
+    /** The start of every line, for looking up many positions in the same source.
+    */
+    struct LineIndex
+    {
+        explicit LineIndex(std::string_view source);
+
+        SourcePosition Find(std::size_t offset) const;
+
+        std::vector<std::size_t> starts;
+    };
+
+    /** Format a error found after parsing the same way as the parse errors.
+    */
+    std::string ErrorAt(const std::string& filename, const SourcePosition& position, const std::string& error);
+}
@@ -0,0 +1,122 @@
+#include "catch.hpp"
+#include "catchy/stringeq.h"
+#include "infofile/infofile.h"
+#include "infofile/spans.h"
+
+using namespace infofile;
+
+namespace
+{
+    struct Parsed
+    {
+        std::string source;
+        SourceSpans spans;
+        std::shared_ptr<Node> root;
+
+        explicit Parsed(const std::string& src)
+            : source(src)
+        {
+            std::vector<std::string> errors;
+            root = ParseWithSpans("inline", source, &errors, &spans);
+            CHECK(errors.empty());
+        }
+
+        std::string Text(Span span) const
+        {
+            return source.substr(span.begin, span.Size());
+        }
+
+        const Node& Get(std::size_t i) const
+        {
+            return *root->children[i];
+        }
+    };
+}
+
+TEST_CASE("spans", "[spans]")
+{
+    const auto p = Parsed{"a b; c = 'd' + e { f } [1, \"2\"]"};
+    const auto a = p.spans.Find(p.Get(0));
+    REQUIRE(a.has_value());
+    CHECK(catchy::StringEq(p.Text(a->node), "a b"));
+    CHECK(catchy::StringEq(p.Text(a->name), "a"));
+    CHECK(catchy::StringEq(p.Text(a->value), "b"));
+    CHECK(a->body.IsEmpty());
+
+    const auto c = p.spans.Find(p.Get(1));
+    REQUIRE(c.has_value());
+    CHECK(catchy::StringEq(p.Text(c->node), "c = 'd' + e { f }"));
+    CHECK(catchy::StringEq(p.Text(c->value), "'d' + e"));
+    CHECK(catchy::StringEq(p.Text(c->body), "{ f }"));
+
+    const auto f = p.spans.Find(*p.Get(1).children[0]);
+    REQUIRE(f.has_value());
+    CHECK(catchy::StringEq(p.Text(f->node), "f"));
+    CHECK(f->value.IsEmpty());
+
+    const auto array = p.spans.Find(p.Get(2));
+    REQUIRE(array.has_value());
+    CHECK(catchy::StringEq(p.Text(array->node), "[1, \"2\"]"));
+    const auto two = p.spans.Find(*p.Get(2).children[1]);
+    REQUIRE(two.has_value());
+    CHECK(catchy::StringEq(p.Text(two->value), "\"2\""));
+
+    CHECK(p.spans.root == p.root.get());
+    CHECK(p.spans.Find(Node{}).has_value() == false);
+    CHECK(p.spans.nodes.size() == 7);
+}
+
+TEST_CASE("source positions", "[spans]")
+{
+    const auto p = Parsed{"a 1\n// comment\nb {\n    color #ff00ff\n}"};
+    const auto color = p.spans.Find(*p.Get(1).children[0]);
+    REQUIRE(color.has_value());
+
+    const auto position = FindPosition(p.source, color->value.begin);
+    CHECK(position.line == 4);
+    CHECK(position.column == 11);
+    CHECK(catchy::StringEq(ErrorAt("inline", position, "bad color"), "inline(4:11): bad color"));
+
+    const auto index = LineIndex{p.source};
+    for (std::size_t offset = 0; offset <= p.source.size(); offset += 1)
+    {
+        const auto lhs = index.Find(offset);
+        const auto rhs = FindPosition(p.source, offset);
+        CHECK(lhs.line == rhs.line);
+        CHECK(lhs.column == rhs.column);
+    }
+
+    const auto first = FindPosition(p.source, 0);
+    CHECK(first.line == 1);
+    CHECK(first.column == 1);
+}
+
+TEST_CASE("source positions match parse errors", "[spans]")
+{
+    const std::string source = "a {\n  b c\n  d $\n}";
+    std::vector<std::string> errors;
+    Parse("inline", source, &errors);
+    REQUIRE(errors.empty() == false);
+    const auto position = FindPosition(source, source.find('$'));
+    const auto prefix = ErrorAt("inline", position, "");
+    CHECK(catchy::StringEq(errors[0].substr(0, prefix.size()), prefix));
+}
+
+TEST_CASE("spans of sources with errors", "[spans]")
+{
+    for (const std::string source : {"a @", "a <<EOF\nxx", "a { b \"c", "a [1, 2"})
+    {
+        std::vector<std::string> errors;
+        SourceSpans spans;
+        ParseWithSpans("inline", source, &errors, &spans);
+        CHECK_FALSE(errors.empty());
+        for (const auto& packed : spans.nodes)
+        {
+            const auto found = spans.Find(*packed.node);
+            REQUIRE(found.has_value());
+            CHECK(found->node.end <= source.size());
+            CHECK(found->value.end <= source.size());
+            CHECK(found->body.end <= source.size());
+        }
+    }
+}
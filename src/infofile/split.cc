@@ -0,0 +1,421 @@
+#include "infofile/split.h"
+
+#include <cstring>
+
+#include "infofile/chars.h"
+
+namespace infofile
+{
+    namespace
+    {
+        struct Scanner
+        {
+            Scanner(const char* d, std::size_t s)
+                : data(d)
+                , size(s)
+                , position(0)
+                , line(0)
+                , offset(0)
+            {
+            }
+
+            // like the lexer, a null character is treated as the end of the file
+            char Peek(std::size_t ahead = 0) const
+            {
+                return position + ahead < size ? data[position + ahead] : 0;
+            }
+
+            void Skip()
+            {
+                if (data[position] == '\n')
+                {
+                    line += 1;
+                    offset = 0;
+                }
+                else
+                {
+                    offset += 1;
+                }
+                position += 1;
+            }
+
+            void SkipLineComment()
+            {
+                while (Peek() != '\n' && Peek() != 0)
+                {
+                    Skip();
+                }
+            }
+
+            bool SkipMultilineComment()
+            {
+                int inside = 0;
+                while (Peek() != 0)
+                {
+                    const auto c = Peek();
+                    Skip();
+                    if (c == '*' && Peek() == '/')
+                    {
+                        Skip();
+                        if (inside == 0)
+                        {
+                            return true;
+                        }
+                        inside -= 1;
+                    }
+                    else if (c == '/' && Peek() == '*')
+                    {
+                        Skip();
+                        inside += 1;
+                    }
+                }
+                return false;
+            }
+
+            bool SkipString(char type)
+            {
+                Skip();
+                if (Peek() == type)
+                {
+                    Skip();
+                    if (Peek() != type)
+                    {
+                        return true;
+                    }
+                    Skip();
+
+                    // multiline string
+                    while (Peek() != 0)
+                    {
+                        if (Peek() == type && Peek(1) == type && Peek(2) == type)
+                        {
+                            Skip();
+                            Skip();
+                            Skip();
+                            return true;
+                        }
+                        if (Peek() == '\\')
+                        {
+                            Skip();
+                            if (Peek() == 0)
+                            {
+                                return false;
+                            }
+                        }
+                        Skip();
+                    }
+                    return false;
+                }
+
+                while (Peek() != 0)
+                {
+                    switch (Peek())
+                    {
+                    case '\n':
+                    case '\r':
+                    case '\t':
+                        return false;
+                    case '\\':
+                        Skip();
+                        if (Peek() == 0)
+                        {
+                            return false;
+                        }
+                        Skip();
+                        break;
+                    default:
+                        if (Peek() == type)
+                        {
+                            Skip();
+                            return true;
+                        }
+                        Skip();
+                        break;
+                    }
+                }
+                return false;
+            }
+
+            bool SkipVerbatimString(char type)
+            {
+                Skip();
+                while (Peek() != 0)
+                {
+                    if (Peek() == type)
+                    {
+                        Skip();
+                        if (Peek() != type)
+                        {
+                            return true;
+                        }
+                        // a doubled quote, the lexer takes the next character without checking for a quote
+                        Skip();
+                    }
+
+                    switch (Peek())
+                    {
+                    case 0:
+                    case '\n':
+                    case '\r':
+                    case '\t':
+                        return false;
+                    default:
+                        Skip();
+                        break;
+                    }
+                }
+                return false;
+            }
+
+            bool SkipHereDoc()
+            {
+                Skip();
+                if (Peek() != '<')
+                {
+                    return false;
+                }
+                Skip();
+
+                const auto name_start = position;
+                while (Peek() != 0 && Peek() != ' ' && Peek() != '\n' && Peek() != '\t')
+                {
+                    Skip();
+                }
+                const auto name_size = position - name_start;
+                if (name_size == 0)
+                {
+                    return false;
+                }
+
+                // the rest of the first line is ignored and the doc ends at the first line starting with the name
+                SkipLineComment();
+                if (Peek() == 0)
+                {
+                    return false;
+                }
+                Skip();
+
+                while (Peek() != 0)
+                {
+                    const auto c = Peek();
+                    Skip();
+                    if (c == '\n' && position + name_size <= size && std::memcmp(data + position, data + name_start, name_size) == 0)
+                    {
+                        SkipLineComment();
+                        if (Peek() == 0)
+                        {
+                            return false;
+                        }
+                        Skip();
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            void SkipWhitespaceAndComments()
+            {
+                for (;;)
+                {
+                    if (IsWhitespace(Peek()))
+                    {
+                        Skip();
+                    }
+                    else if (Peek() == '/' && Peek(1) == '/')
+                    {
+                        SkipLineComment();
+                    }
+                    else if (Peek() == '/' && Peek(1) == '*')
+                    {
+                        Skip();
+                        Skip();
+                        if (SkipMultilineComment() == false)
+                        {
+                            return;
+                        }
+                    }
+                    else
+                    {
+                        return;
+                    }
+                }
+            }
+
+            /** Skip anything that isn't a bracket or a separator, returns false if it looks suspicious.
+            */
+            bool SkipOther()
+            {
+                const auto c = Peek();
+                switch (c)
+                {
+                case '/':
+                    Skip();
+                    if (Peek() == '/')
+                    {
+                        SkipLineComment();
+                        return true;
+                    }
+                    if (Peek() == '*')
+                    {
+                        Skip();
+                        return SkipMultilineComment();
+                    }
+                    return false;
+                case '"':
+                case '\'':
+                    return SkipString(c);
+                case '@':
+                    Skip();
+                    if (Peek() != '"' && Peek() != '\'')
+                    {
+                        return false;
+                    }
+                    return SkipVerbatimString(Peek());
+                case '<':
+                    return SkipHereDoc();
+                default:
+                    if (IsIdentChar(c, true))
+                    {
+                        // skip the whole ident so a @ inside it isn't mistaken for a verbatim string
+                        while (IsIdentChar(Peek(), false))
+                        {
+                            Skip();
+                        }
+                    }
+                    else
+                    {
+                        Skip();
+                    }
+                    return true;
+                }
+            }
+
+            SplitPoint Here() const
+            {
+                return {position, line, offset};
+            }
+
+            const char* data;
+            std::size_t size;
+            std::size_t position;
+            int line;
+            int offset;
+        };
+    }
+
+    std::vector<SplitPoint> FindTopLevelSplits(const char* data, std::size_t size, std::size_t chunk_size)
+    {
+        auto scanner = Scanner{data, size};
+        std::vector<SplitPoint> splits;
+
+        scanner.SkipWhitespaceAndComments();
+        if (scanner.Peek() == '{' || scanner.Peek() == '[')
+        {
+            // not a root without braces
+            return {};
+        }
+
+        std::size_t last_split = 0;
+        int depth = 0;
+
+        auto can_split = [&]() { return depth == 0 && scanner.position - last_split >= chunk_size; };
+        auto split = [&]() {
+            splits.emplace_back(scanner.Here());
+            last_split = scanner.position;
+        };
+
+        while (scanner.Peek() != 0)
+        {
+            const auto c = scanner.Peek();
+            switch (c)
+            {
+            case '{':
+            case '[':
+                depth += 1;
+                scanner.Skip();
+                break;
+            case '}':
+            case ']':
+                depth -= 1;
+                if (depth < 0)
+                {
+                    return {};
+                }
+                scanner.Skip();
+                if (can_split())
+                {
+                    // a separator following the struct belongs to the node, split after that instead
+                    auto lookahead = scanner;
+                    lookahead.SkipWhitespaceAndComments();
+                    const auto after = lookahead.Peek();
+                    if (after != 0 && after != ';' && after != ',' && after != '+' && after != '\\')
+                    {
+                        split();
+                    }
+                }
+                break;
+            case ';':
+            case ',':
+                scanner.Skip();
+                if (can_split())
+                {
+                    split();
+                }
+                break;
+            default:
+                if (scanner.SkipOther() == false)
+                {
+                    return {};
+                }
+                break;
+            }
+        }
+
+        return splits;
+    }
+
+    bool FindBrackets(const char* data, std::size_t size, std::vector<BracketRegion>* regions)
+    {
+        auto scanner = Scanner{data, size};
+        std::vector<std::size_t> open;
+        regions->clear();
+
+        while (scanner.Peek() != 0)
+        {
+            const auto c = scanner.Peek();
+            switch (c)
+            {
+            case '{':
+            case '[':
+                open.emplace_back(regions->size());
+                regions->emplace_back(BracketRegion{scanner.position, 0, open.size() > 1 ? open[open.size() - 2] : BracketRegion::NO_PARENT});
+                scanner.Skip();
+                break;
+            case '}':
+            case ']':
+            {
+                if (open.empty() || data[(*regions)[open.back()].begin] != (c == '}' ? '{' : '['))
+                {
+                    return false;
+                }
+                scanner.Skip();
+                (*regions)[open.back()].end = scanner.position;
+                open.pop_back();
+                break;
+            }
+            case ';':
+            case ',':
+                scanner.Skip();
+                break;
+            default:
+                if (scanner.SkipOther() == false)
+                {
+                    return false;
+                }
+                break;
+            }
+        }
+
+        return open.empty();
+    }
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace infofile
+{
+    /** A place in the source where a new top level node starts.
+    */
+    struct SplitPoint
+    {
+        std::size_t position;
+        int line;
+        int offset;
+    };
+
+    /** Quickly scan the source of a root node without braces and find places where it can be split into chunks
+    that can be parsed independently, at least chunk_size bytes apart.
+    Strings, heredocs and comments are skipped so the split points are always between top level nodes.
+    If the source doesn't look like a root node without braces or anything looks suspicious no split points are
+    returned and the source should be parsed as a whole.
+    */
+    std::vector<SplitPoint> FindTopLevelSplits(const char* data, std::size_t size, std::size_t chunk_size);
+
+    /** A {...} or [...] in the source.
+    */
+    struct BracketRegion
+    {
+        static constexpr std::size_t NO_PARENT = static_cast<std::size_t>(-1);
+
+        /** The position of the opening bracket and one past the closing bracket.
+        */
+        std::size_t begin;
+        std::size_t end;
+
+        /** Index of the enclosing region or NO_PARENT.
+        */
+        std::size_t parent;
+    };
+
+    /** Find all bracket regions in the source, ordered by where they begin.
+    Like FindTopLevelSplits strings, heredocs and comments are skipped, returns false if the brackets don't match
+    or anything looks suspicious.
+    */
+    bool FindBrackets(const char* data, std::size_t size, std::vector<BracketRegion>* regions);
+}
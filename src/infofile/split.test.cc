@@ -0,0 +1,102 @@
+#include "catch.hpp"
+#include "catchy/stringeq.h"
+#include "infofile/infofile.h"
+#include "infofile/split.h"
+
+using namespace infofile;
+
+namespace
+{
+    std::vector<std::size_t> Splits(const std::string& src)
+    {
+        std::vector<std::size_t> r;
+        for (const auto& s : FindTopLevelSplits(src.data(), src.size(), 1))
+        {
+            r.emplace_back(s.position);
+        }
+        return r;
+    }
+
+    void CheckSameAsParse(const std::string& src)
+    {
+        std::vector<std::string> errors;
+        auto expected = Parse("inline", src, &errors);
+
+        ParallelParseOptions options;
+        options.threads = 3;
+        options.chunk_size = 1;
+        std::vector<std::string> parallel_errors;
+        auto parallel = ParseParallel("inline", src, &parallel_errors, options);
+
+        REQUIRE(catchy::StringEq(parallel_errors, errors));
+        REQUIRE(catchy::StringEq(PrintToString(PrintOptions{}, parallel), PrintToString(PrintOptions{}, expected)));
+    }
+}
+
+TEST_CASE("split points", "[split]")
+{
+    SECTION("separators")
+    {
+        CHECK(Splits("a b; c d; e f") == std::vector<std::size_t>{4, 9});
+    }
+
+    SECTION("after struct")
+    {
+        CHECK(Splits("a {b c} d {e f} g h") == std::vector<std::size_t>{7, 15});
+    }
+
+    SECTION("not before separator")
+    {
+        CHECK(Splits("a {b c} ; d e") == std::vector<std::size_t>{9});
+    }
+
+    SECTION("not inside struct")
+    {
+        CHECK(Splits("a {b c; d e;} f g") == std::vector<std::size_t>{13});
+    }
+
+    SECTION("not inside strings and comments")
+    {
+        CHECK(Splits("a \"b;c\" // d;e\n f /* g; } */ h").empty());
+        CHECK(Splits("a '''b;\n}c''' d @\"e;\"\"f\" g").empty());
+        CHECK(Splits("a <<EOF\n;}\nEOF\nb c").empty());
+    }
+
+    SECTION("root with braces")
+    {
+        CHECK(Splits("{a b; c d}").empty());
+        CHECK(Splits("// comment\n[a, b, c]").empty());
+    }
+
+    SECTION("unbalanced")
+    {
+        CHECK(Splits("a b; } c d;").empty());
+    }
+
+    SECTION("line numbers")
+    {
+        const std::string src = "a b;\nc d;\n  e f;";
+        const auto splits = FindTopLevelSplits(src.data(), src.size(), 1);
+        REQUIRE(3 == splits.size());
+        CHECK(0 == splits[0].line);
+        CHECK(4 == splits[0].offset);
+        CHECK(1 == splits[1].line);
+        CHECK(4 == splits[1].offset);
+        CHECK(2 == splits[2].line);
+        CHECK(6 == splits[2].offset);
+    }
+}
+
+TEST_CASE("parallel parse is same as parse", "[split]")
+{
+    CheckSameAsParse("");
+    CheckSameAsParse("a b; c d; e f");
+    CheckSameAsParse("a {b c} d [e f] g h; i {j k};; l m,");
+    CheckSameAsParse("a \"b;c\" // d;e\n f /* g; } */ h; i j");
+    CheckSameAsParse("a <<EOF ignored\n;}\nEOF\nb c; d e");
+    CheckSameAsParse("a = \"hello\" + \" world\"; b c; d 'x\\q';\ne f; g \"bad\nline\";");
+    CheckSameAsParse("a b;\n c d;\n e $ f; g h; i j");
+    CheckSameAsParse("a b; } c d; e f");
+    CheckSameAsParse("[a, b, c]");
+    CheckSameAsParse("the.dude@gmail.com x; y z");
+}
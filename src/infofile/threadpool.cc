@@ -0,0 +1,156 @@
+#include "infofile/threadpool.h"
+
+#include <cassert>
+
+namespace infofile
+{
+    namespace
+    {
+        // the pool and index of the worker running on this thread, if any
+        thread_local ThreadPool* current_pool = nullptr;
+        thread_local std::size_t current_worker = 0;
+    }
+
+    std::size_t DefaultThreadCount()
+    {
+        const auto count = std::thread::hardware_concurrency();
+        return count == 0 ? 1 : count;
+    }
+
+    ThreadPool::ThreadPool(std::size_t thread_count)
+        : queued(0)
+        , pending(0)
+        , next_queue(0)
+        , stopping(false)
+    {
+        const auto count = thread_count == 0 ? DefaultThreadCount() : thread_count;
+        for (std::size_t i = 0; i < count; i += 1)
+        {
+            queues.emplace_back(std::make_unique<Queue>());
+        }
+        for (std::size_t i = 0; i < count; i += 1)
+        {
+            threads.emplace_back([this, i]() { WorkerMain(i); });
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+    }
+
+    void ThreadPool::Submit(std::function<void()> task)
+    {
+        std::size_t index = 0;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (current_pool == this)
+            {
+                index = current_worker;
+            }
+            else
+            {
+                index = next_queue;
+                next_queue = (next_queue + 1) % queues.size();
+            }
+        }
+
+        {
+            auto& queue = *queues[index];
+            std::unique_lock<std::mutex> lock(queue.mutex);
+            queue.tasks.emplace_back(std::move(task));
+        }
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            queued += 1;
+            pending += 1;
+        }
+        wake.notify_one();
+    }
+
+    void ThreadPool::Wait()
+    {
+        assert(current_pool != this);
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this]() { return pending == 0; });
+    }
+
+    std::size_t ThreadPool::ThreadCount() const
+    {
+        return threads.size();
+    }
+
+    std::function<void()> ThreadPool::TakeTask(std::size_t self)
+    {
+        // the caller has reserved a task so there is guaranteed to be one in some queue
+        for (;;)
+        {
+            {
+                auto& own = *queues[self];
+                std::unique_lock<std::mutex> lock(own.mutex);
+                if (own.tasks.empty() == false)
+                {
+                    auto task = std::move(own.tasks.back());
+                    own.tasks.pop_back();
+                    return task;
+                }
+            }
+
+            for (std::size_t offset = 1; offset < queues.size(); offset += 1)
+            {
+                auto& other = *queues[(self + offset) % queues.size()];
+                std::unique_lock<std::mutex> lock(other.mutex);
+                if (other.tasks.empty() == false)
+                {
+                    auto task = std::move(other.tasks.front());
+                    other.tasks.pop_front();
+                    return task;
+                }
+            }
+
+            std::this_thread::yield();
+        }
+    }
+
+    void ThreadPool::WorkerMain(std::size_t self)
+    {
+        current_pool = this;
+        current_worker = self;
+
+        for (;;)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this]() { return stopping || queued > 0; });
+                if (queued == 0)
+                {
+                    return;
+                }
+                queued -= 1;
+            }
+
+            auto task = TakeTask(self);
+            task();
+
+            bool all_done = false;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                pending -= 1;
+                all_done = pending == 0;
+            }
+            if (all_done)
+            {
+                done.notify_all();
+            }
+        }
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace infofile
+{
+    /** A work stealing thread pool.
+    Every worker has its own queue, tasks submitted from a worker are placed on the workers own queue
+    and idle workers steal from the front of the other queues.
+    */
+    struct ThreadPool
+    {
+        /** 0 threads means one per hardware thread.
+        */
+        explicit ThreadPool(std::size_t thread_count);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        void operator=(const ThreadPool&) = delete;
+
+        void Submit(std::function<void()> task);
+
+        /** Block until all submitted tasks have completed.
+        Don't call from inside a task.
+        */
+        void Wait();
+
+        std::size_t ThreadCount() const;
+
+        struct Queue
+        {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        std::function<void()> TakeTask(std::size_t self);
+        void WorkerMain(std::size_t self);
+
+        std::vector<std::unique_ptr<Queue>> queues;
+        std::vector<std::thread> threads;
+
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::condition_variable done;
+        std::size_t queued;
+        std::size_t pending;
+        std::size_t next_queue;
+        bool stopping;
+    };
+
+    std::size_t DefaultThreadCount();
+}
@@ -0,0 +1,55 @@
+#include <atomic>
+
+#include "catch.hpp"
+#include "infofile/threadpool.h"
+
+using namespace infofile;
+
+TEST_CASE("thread pool runs all tasks", "[threadpool]")
+{
+    ThreadPool pool{4};
+    REQUIRE(4 == pool.ThreadCount());
+
+    std::atomic<int> sum = 0;
+    for (int i = 1; i <= 100; i += 1)
+    {
+        pool.Submit([&sum, i]() { sum += i; });
+    }
+    pool.Wait();
+
+    CHECK(5050 == sum);
+}
+
+TEST_CASE("thread pool tasks can submit tasks", "[threadpool]")
+{
+    ThreadPool pool{3};
+
+    std::atomic<int> count = 0;
+    for (int i = 0; i < 10; i += 1)
+    {
+        pool.Submit([&pool, &count]() {
+            count += 1;
+            for (int j = 0; j < 10; j += 1)
+            {
+                pool.Submit([&count]() { count += 1; });
+            }
+        });
+    }
+    pool.Wait();
+
+    CHECK(110 == count);
+}
+
+TEST_CASE("thread pool can be reused after wait", "[threadpool]")
+{
+    ThreadPool pool{2};
+
+    std::atomic<int> count = 0;
+    pool.Submit([&count]() { count += 1; });
+    pool.Wait();
+    CHECK(1 == count);
+
+    pool.Submit([&count]() { count += 1; });
+    pool.Wait();
+    CHECK(2 == count);
+}
@@ -0,0 +1,408 @@
+#include "infofile/watcher.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+
+#include "infofile/fingerprint.h"
+#include "infofile/infofile.h"
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <cstring>
+#endif
+
+namespace infofile
+{
+    WatchOptions::WatchOptions()
+        : debounce(100)
+        , threads(0)
+    {
+    }
+
+    DirectoryWatcher::DirectoryWatcher(const std::string& directory, const WatchOptions& o, OnFileChanged changed)
+        : options(o)
+        , on_changed(changed ? std::move(changed) : [](const FileChange&) {})
+        , inotify_fd(-1)
+        , stop_fd(-1)
+    {
+#if defined(__linux__)
+        inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        stop_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (inotify_fd < 0 || stop_fd < 0)
+        {
+            if (inotify_fd >= 0)
+            {
+                close(inotify_fd);
+            }
+            if (stop_fd >= 0)
+            {
+                close(stop_fd);
+            }
+            inotify_fd = -1;
+            stop_fd = -1;
+        }
+#endif
+
+        // watch before reading so changes made while reading are not lost
+        std::vector<std::string> filenames;
+        if (IsWatching())
+        {
+            AddWatch(directory);
+        }
+        ScanDirectory(directory, &filenames);
+
+        ReadFilesOptions read;
+        read.threads = options.threads;
+        for (auto& result : ReadFiles(filenames, read))
+        {
+            if (result.errors.empty())
+            {
+                roots[result.filename] = result.root;
+            }
+            else
+            {
+                errors[result.filename] = std::move(result.errors);
+            }
+        }
+
+        if (IsWatching())
+        {
+            thread = std::thread([this]() { WatcherMain(); });
+        }
+    }
+
+    DirectoryWatcher::~DirectoryWatcher()
+    {
+#if defined(__linux__)
+        if (IsWatching())
+        {
+            const std::uint64_t one = 1;
+            [[maybe_unused]] const auto written = write(stop_fd, &one, sizeof(one));
+            thread.join();
+            close(inotify_fd);
+            close(stop_fd);
+        }
+#endif
+    }
+
+    bool DirectoryWatcher::IsWatching() const
+    {
+        return inotify_fd >= 0;
+    }
+
+    std::shared_ptr<Node> DirectoryWatcher::Root(const std::string& filename)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = roots.find(filename);
+        return found != roots.end() ? found->second : nullptr;
+    }
+
+    std::vector<std::string> DirectoryWatcher::Filenames()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<std::string> filenames;
+        for (const auto& [filename, root] : roots)
+        {
+            filenames.emplace_back(filename);
+        }
+        return filenames;
+    }
+
+    std::vector<std::string> DirectoryWatcher::Errors(const std::string& filename)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = errors.find(filename);
+        return found != errors.end() ? found->second : std::vector<std::string>{};
+    }
+
+    std::vector<std::string> DirectoryWatcher::FilesWithErrors()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<std::string> filenames;
+        for (const auto& [filename, file_errors] : errors)
+        {
+            filenames.emplace_back(filename);
+        }
+        return filenames;
+    }
+
+    void DirectoryWatcher::ScanDirectory(const std::string& directory, std::vector<std::string>* filenames)
+    {
+        std::error_code error;
+        for (auto it = std::filesystem::recursive_directory_iterator(directory, error); it != std::filesystem::recursive_directory_iterator(); it.increment(error))
+        {
+            if (error)
+            {
+                break;
+            }
+            if (it->is_directory(error))
+            {
+                if (IsWatching())
+                {
+                    AddWatch(it->path().string());
+                }
+            }
+            else if (it->is_regular_file(error) && (options.extension.empty() || it->path().extension() == options.extension))
+            {
+                filenames->emplace_back(it->path().string());
+            }
+        }
+    }
+
+    bool DirectoryWatcher::AddWatch(const std::string& directory)
+    {
+#if defined(__linux__)
+        const auto wd = inotify_add_watch(inotify_fd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE);
+        if (wd >= 0)
+        {
+            watched_directories[wd] = directory;
+            return true;
+        }
+#else
+        static_cast<void>(directory);
+#endif
+        return false;
+    }
+
+    void DirectoryWatcher::RemoveWatches(const std::string& directory)
+    {
+#if defined(__linux__)
+        const auto prefix = directory + static_cast<char>(std::filesystem::path::preferred_separator);
+        for (auto it = watched_directories.begin(); it != watched_directories.end();)
+        {
+            if (it->second == directory || it->second.compare(0, prefix.size(), prefix) == 0)
+            {
+                inotify_rm_watch(inotify_fd, it->first);
+                it = watched_directories.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+#else
+        static_cast<void>(directory);
+#endif
+    }
+
+    void DirectoryWatcher::WatcherMain()
+    {
+#if defined(__linux__)
+        using Clock = std::chrono::steady_clock;
+
+        // the time of the last event of every changed file, each is reloaded once it has been left alone for the debounce time
+        std::map<std::string, Clock::time_point> pending;
+        const auto add_pending = [&pending](const std::string& path) { pending[path] = Clock::now(); };
+
+        alignas(inotify_event) char buffer[16 * 1024];
+        while (true)
+        {
+            int timeout = -1;
+            if (pending.empty() == false)
+            {
+                auto oldest = Clock::time_point::max();
+                for (const auto& [path, changed] : pending)
+                {
+                    oldest = std::min(oldest, changed);
+                }
+                const auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - oldest);
+                timeout = waited >= options.debounce ? 0 : static_cast<int>((options.debounce - waited).count());
+            }
+
+            pollfd fds[2] = {{inotify_fd, POLLIN, 0}, {stop_fd, POLLIN, 0}};
+            if (poll(fds, 2, timeout) < 0)
+            {
+                continue;
+            }
+            if (fds[1].revents != 0)
+            {
+                return;
+            }
+
+            std::vector<std::string> quiet;
+            const auto now = Clock::now();
+            for (const auto& [path, changed] : pending)
+            {
+                if (now - changed >= options.debounce)
+                {
+                    quiet.emplace_back(path);
+                }
+            }
+            if (quiet.empty() == false)
+            {
+                for (const auto& path : quiet)
+                {
+                    pending.erase(path);
+                }
+                Reload(quiet);
+            }
+
+            if (fds[0].revents == 0)
+            {
+                continue;
+            }
+
+            const auto size = read(inotify_fd, buffer, sizeof(buffer));
+            if (size <= 0)
+            {
+                continue;
+            }
+
+            for (std::size_t offset = 0; offset + sizeof(inotify_event) <= static_cast<std::size_t>(size);)
+            {
+                inotify_event event;
+                std::memcpy(&event, buffer + offset, sizeof(event));
+                const std::string name = event.len > 0 ? std::string(buffer + offset + sizeof(event)) : std::string();
+                offset += sizeof(event) + event.len;
+
+                if ((event.mask & IN_Q_OVERFLOW) != 0)
+                {
+                    // events were lost, check all files
+                    std::vector<std::string> filenames = Filenames();
+                    for (const auto& [wd, directory] : watched_directories)
+                    {
+                        ScanDirectory(directory, &filenames);
+                    }
+                    std::for_each(filenames.begin(), filenames.end(), add_pending);
+                    continue;
+                }
+                if ((event.mask & IN_IGNORED) != 0)
+                {
+                    watched_directories.erase(event.wd);
+                    continue;
+                }
+
+                auto directory = watched_directories.find(event.wd);
+                if (directory == watched_directories.end() || name.empty())
+                {
+                    continue;
+                }
+                const auto path = (std::filesystem::path(directory->second) / name).string();
+
+                if ((event.mask & IN_ISDIR) != 0)
+                {
+                    if ((event.mask & (IN_CREATE | IN_MOVED_TO)) != 0)
+                    {
+                        // files may have been added before the new directory was watched
+                        std::vector<std::string> filenames;
+                        AddWatch(path);
+                        ScanDirectory(path, &filenames);
+                        std::for_each(filenames.begin(), filenames.end(), add_pending);
+                    }
+                    else if ((event.mask & IN_MOVED_FROM) != 0)
+                    {
+                        // the watches would follow the directory out of the tree, and its files are gone like a delete
+                        RemoveWatches(path);
+                        const auto prefix = path + static_cast<char>(std::filesystem::path::preferred_separator);
+                        auto filenames = Filenames();
+                        const auto with_errors = FilesWithErrors();
+                        filenames.insert(filenames.end(), with_errors.begin(), with_errors.end());
+                        for (const auto& filename : filenames)
+                        {
+                            if (filename.compare(0, prefix.size(), prefix) == 0)
+                            {
+                                add_pending(filename);
+                            }
+                        }
+                    }
+                    continue;
+                }
+
+                if ((event.mask & IN_CREATE) != 0)
+                {
+                    // wait for the file to be closed
+                    continue;
+                }
+                if (options.extension.empty() || std::filesystem::path(name).extension() == options.extension)
+                {
+                    add_pending(path);
+                }
+            }
+        }
+#endif
+    }
+
+    void DirectoryWatcher::Reload(const std::vector<std::string>& filenames)
+    {
+        std::vector<std::string> existing;
+        std::vector<std::string> removed;
+        for (const auto& filename : filenames)
+        {
+            std::error_code error;
+            if (std::filesystem::is_regular_file(filename, error))
+            {
+                existing.emplace_back(filename);
+            }
+            else
+            {
+                removed.emplace_back(filename);
+            }
+        }
+
+        ReadFilesOptions read;
+        read.threads = options.threads;
+        auto results = ReadFiles(existing, read);
+
+        const Node empty;
+        for (auto& result : results)
+        {
+            FingerprintCache cache;
+            FileChange change;
+            change.filename = result.filename;
+            change.old_root = Root(result.filename);
+            if (result.errors.empty() == false)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    errors[change.filename] = result.errors;
+                }
+                change.errors = std::move(result.errors);
+                on_changed(change);
+                continue;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                errors.erase(change.filename);
+            }
+
+            change.new_root = result.root;
+            change.changed_keys = ChangedKeys(change.old_root ? *change.old_root : empty, *change.new_root, &cache);
+            if (change.old_root != nullptr && cache.Get(*change.old_root) == cache.Get(*change.new_root))
+            {
+                continue;
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                roots[change.filename] = change.new_root;
+            }
+            on_changed(change);
+        }
+
+        for (const auto& filename : removed)
+        {
+            FingerprintCache cache;
+            FileChange change;
+            change.filename = filename;
+            change.old_root = Root(filename);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                errors.erase(filename);
+            }
+            if (change.old_root == nullptr)
+            {
+                continue;
+            }
+            change.changed_keys = ChangedKeys(*change.old_root, empty, &cache);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                roots.erase(filename);
+            }
+            on_changed(change);
+        }
+    }
+}
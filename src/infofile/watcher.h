@@ -0,0 +1,98 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "infofile/node.h"
+
+namespace infofile
+{
+    struct WatchOptions
+    {
+        WatchOptions();
+
+        /** Only watch files with this extension, like ".info". Empty means all files.
+        */
+        std::string extension;
+
+        /** How long a file must be left alone after a change before it's reparsed.
+        Each file is timed on it's own, so a busy file doesn't hold back the others.
+        */
+        std::chrono::milliseconds debounce;
+
+        /** Number of threads parsing the changed files, 0 means one per hardware thread.
+        */
+        std::size_t threads;
+    };
+
+    /** A file that changed on disk.
+    new_root is null if the file was removed or has errors, in the later case the old root is kept.
+    old_root is null if the file is new.
+    */
+    struct FileChange
+    {
+        std::string filename;
+        std::shared_ptr<Node> old_root;
+        std::shared_ptr<Node> new_root;
+        std::vector<std::string> changed_keys;
+        std::vector<std::string> errors;
+    };
+
+    /** Called on the watcher thread for every file that changed.
+    */
+    using OnFileChanged = std::function<void(const FileChange& change)>;
+
+    /** Reads all files in a directory and it's subdirectories, and then reparses only the files that change using inotify.
+    Files saved with the same content don't report a change.
+    */
+    struct DirectoryWatcher
+    {
+        DirectoryWatcher(const std::string& directory, const WatchOptions& options, OnFileChanged on_changed);
+        ~DirectoryWatcher();
+
+        DirectoryWatcher(const DirectoryWatcher&) = delete;
+        void operator=(const DirectoryWatcher&) = delete;
+
+        /** False if the directory couldn't be watched, for example when not running on linux.
+        The files are still read once.
+        */
+        bool IsWatching() const;
+
+        /** The current root of a file, or null if it isn't loaded.
+        */
+        std::shared_ptr<Node> Root(const std::string& filename);
+
+        std::vector<std::string> Filenames();
+
+        /** The errors of the last time the file was read, empty if it parsed.
+        Files that failed when the watcher started have no root but are listed here.
+        */
+        std::vector<std::string> Errors(const std::string& filename);
+        std::vector<std::string> FilesWithErrors();
+
+        void WatcherMain();
+        bool AddWatch(const std::string& directory);
+        void RemoveWatches(const std::string& directory);
+        void ScanDirectory(const std::string& directory, std::vector<std::string>* filenames);
+        void Reload(const std::vector<std::string>& filenames);
+
+        WatchOptions options;
+        OnFileChanged on_changed;
+
+        std::mutex mutex;
+        std::map<std::string, std::shared_ptr<Node>> roots;
+        std::map<std::string, std::vector<std::string>> errors;
+
+        int inotify_fd;
+        int stop_fd;
+        std::map<int, std::string> watched_directories;
+        std::thread thread;
+    };
+}
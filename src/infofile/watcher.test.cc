@@ -0,0 +1,191 @@
+#include <algorithm>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+#include "catch.hpp"
+#include "catchy/stringeq.h"
+#include "fmt/core.h"
+#include "infofile/watcher.h"
+
+using namespace infofile;
+
+namespace
+{
+    void WriteFile(const std::filesystem::path& path, const std::string& content)
+    {
+        std::ofstream f{path, std::ios::binary};
+        f << content;
+    }
+
+    struct Changes
+    {
+        void Add(const FileChange& change)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            changes.emplace_back(change);
+            changed.notify_all();
+        }
+
+        /** True if the file has been reported at least count times.
+        */
+        bool Has(const std::string& filename, std::size_t count)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            const auto same = [&filename](const FileChange& change) { return change.filename == filename; };
+            return static_cast<std::size_t>(std::count_if(changes.begin(), changes.end(), same)) >= count;
+        }
+
+        bool WaitFor(std::size_t count)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            return changed.wait_for(lock, std::chrono::seconds(10), [this, count]() { return changes.size() >= count; });
+        }
+
+        std::mutex mutex;
+        std::condition_variable changed;
+        std::vector<FileChange> changes;
+    };
+}
+
+TEST_CASE("directory watcher", "[watcher]")
+{
+    const auto dir = std::filesystem::temp_directory_path() / "infofile_test_watcher";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir / "sub");
+    const auto a = (dir / "a.info").string();
+    const auto b = (dir / "sub" / "b.info").string();
+    WriteFile(a, "x 1; y 2");
+    WriteFile(b, "z 3");
+    WriteFile(dir / "ignored.txt", "{");
+    WriteFile(dir / "broken.info", "{");
+
+    WatchOptions options;
+    options.extension = ".info";
+    options.debounce = std::chrono::milliseconds(50);
+
+    Changes changes;
+    {
+        DirectoryWatcher watcher{dir.string(), options, [&changes](const FileChange& change) { changes.Add(change); }};
+        CHECK(2 == watcher.Filenames().size());
+        REQUIRE(watcher.Root(a) != nullptr);
+        CHECK(watcher.Errors(a).empty());
+
+        // files that fail on the first read are reported
+        const auto broken = (dir / "broken.info").string();
+        CHECK(watcher.Root(broken) == nullptr);
+        CHECK_FALSE(watcher.Errors(broken).empty());
+        CHECK(watcher.FilesWithErrors() == std::vector<std::string>{broken});
+
+        if (watcher.IsWatching())
+        {
+            // rapid writes are reported once
+            WriteFile(a, "x 1; y 3");
+            WriteFile(a, "x 1; y 4");
+            WriteFile(a, "x 1; y 5");
+            REQUIRE(changes.WaitFor(1));
+            {
+                std::lock_guard<std::mutex> lock(changes.mutex);
+                REQUIRE(1 == changes.changes.size());
+                const auto& change = changes.changes[0];
+                CHECK(catchy::StringEq(change.filename, a));
+                CHECK(change.changed_keys == std::vector<std::string>{"y"});
+                CHECK(catchy::StringEq(change.old_root->children[1]->value, "2"));
+                CHECK(catchy::StringEq(change.new_root->children[1]->value, "5"));
+            }
+            CHECK(catchy::StringEq(watcher.Root(a)->children[1]->value, "5"));
+
+            // a broken file keeps the old root
+            WriteFile(b, "z {");
+            REQUIRE(changes.WaitFor(2));
+            {
+                std::lock_guard<std::mutex> lock(changes.mutex);
+                CHECK(changes.changes[1].new_root == nullptr);
+                CHECK_FALSE(changes.changes[1].errors.empty());
+            }
+            CHECK(watcher.Root(b) != nullptr);
+            CHECK_FALSE(watcher.Errors(b).empty());
+
+            std::filesystem::remove(a);
+            REQUIRE(changes.WaitFor(3));
+            {
+                std::lock_guard<std::mutex> lock(changes.mutex);
+                CHECK(catchy::StringEq(changes.changes[2].filename, a));
+                CHECK(changes.changes[2].new_root == nullptr);
+                CHECK(changes.changes[2].changed_keys == std::vector<std::string>{"x", "y"});
+            }
+            CHECK(watcher.Root(a) == nullptr);
+
+            // new directories are watched
+            std::filesystem::create_directories(dir / "new");
+            WriteFile(dir / "new" / "c.info", "w 1");
+            REQUIRE(changes.WaitFor(4));
+            {
+                std::lock_guard<std::mutex> lock(changes.mutex);
+                CHECK(changes.changes[3].old_root == nullptr);
+                CHECK(changes.changes[3].changed_keys == std::vector<std::string>{"w"});
+            }
+
+            // a file that keeps changing doesn't hold back the others
+            const auto c = (dir / "new" / "c.info").string();
+            WriteFile(c, "w 2");
+            for (int i = 0; i < 500 && changes.Has(c, 2) == false; i += 1)
+            {
+                WriteFile(dir / "busy.info", fmt::format("v {}", i));
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            CHECK(changes.Has(c, 2));
+        }
+    }
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("directory watcher sees directories moved out", "[watcher]")
+{
+    const auto dir = std::filesystem::temp_directory_path() / "infofile_test_watcher_move";
+    const auto moved = std::filesystem::temp_directory_path() / "infofile_test_watcher_moved";
+    std::filesystem::remove_all(dir);
+    std::filesystem::remove_all(moved);
+    std::filesystem::create_directories(dir / "inner" / "deep");
+    const auto d = (dir / "inner" / "deep" / "d.info").string();
+    const auto e = (dir / "inner" / "e.info").string();
+    const auto f = (dir / "inner" / "f.info").string();
+    const auto kept = (dir / "kept.info").string();
+    WriteFile(d, "d 1");
+    WriteFile(e, "e 1");
+    WriteFile(f, "{");
+    WriteFile(kept, "k 1");
+
+    WatchOptions options;
+    options.extension = ".info";
+    options.debounce = std::chrono::milliseconds(50);
+
+    Changes changes;
+    {
+        DirectoryWatcher watcher{dir.string(), options, [&changes](const FileChange& change) { changes.Add(change); }};
+        CHECK(3 == watcher.Filenames().size());
+        CHECK(watcher.FilesWithErrors() == std::vector<std::string>{f});
+
+        if (watcher.IsWatching())
+        {
+            std::filesystem::rename(dir / "inner", moved);
+            REQUIRE(changes.WaitFor(2));
+            {
+                std::lock_guard<std::mutex> lock(changes.mutex);
+                REQUIRE(2 == changes.changes.size());
+                for (const auto& change : changes.changes)
+                {
+                    CHECK((change.filename == d || change.filename == e));
+                    CHECK(change.new_root == nullptr);
+                    CHECK(change.changed_keys.size() == 1);
+                }
+            }
+            CHECK(watcher.Filenames() == std::vector<std::string>{kept});
+            CHECK(watcher.FilesWithErrors().empty());
+        }
+    }
+    std::filesystem::remove_all(dir);
+    std::filesystem::remove_all(moved);
+}
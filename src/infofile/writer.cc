@@ -0,0 +1,86 @@
+#include "infofile/writer.h"
+
+namespace infofile
+{
+    Writer::Writer(PrintBuffer* b, const PrintOptions& o)
+        : buffer(b)
+        , options(o)
+        , indents(o.tab)
+        , header_pending(false)
+    {
+    }
+
+    void Writer::BeginStruct(std::string_view name, std::string_view value)
+    {
+        Begin(name, value);
+    }
+
+    void Writer::BeginArray(std::string_view name)
+    {
+        Begin(name, "");
+    }
+
+    void Writer::Value(std::string_view name, std::string_view value)
+    {
+        WriteOpenHeader();
+        WriteHeader(open.size(), name, value);
+        buffer->Write(options.term);
+        buffer->Write(options.newline);
+    }
+
+    bool Writer::End()
+    {
+        if (open.empty())
+        {
+            return false;
+        }
+
+        if (header_pending)
+        {
+            // no children, printed like a value
+            header_pending = false;
+            WriteHeader(open.size() - 1, open.back().name, open.back().value);
+        }
+        else
+        {
+            buffer->Write(indents.Get(open.size() - 1));
+            buffer->Write('}');
+        }
+        buffer->Write(options.term);
+        buffer->Write(options.newline);
+        open.pop_back();
+        return true;
+    }
+
+    std::size_t Writer::Depth() const
+    {
+        return open.size();
+    }
+
+    void Writer::Begin(std::string_view name, std::string_view value)
+    {
+        WriteOpenHeader();
+        open.emplace_back(Open{std::string{name}, std::string{value}});
+        header_pending = true;
+    }
+
+    void Writer::WriteHeader(std::size_t depth, std::string_view name, std::string_view value)
+    {
+        buffer->Write(indents.Get(depth));
+        buffer->WriteString(name);
+        buffer->Write(' ');
+        buffer->WriteString(value);
+    }
+
+    void Writer::WriteOpenHeader()
+    {
+        if (header_pending == false)
+        {
+            return;
+        }
+        header_pending = false;
+        WriteHeader(open.size() - 1, open.back().name, open.back().value);
+        buffer->Write(" {");
+        buffer->Write(options.newline);
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "infofile/infofile.h"
+#include "infofile/printbuffer.h"
+
+namespace infofile
+{
+    /** Writes nodes directly to a print buffer without building a tree, the output is the same as printing the tree.
+    Only the names and values of the open structs are kept.
+    The compact option isn't supported since it needs to know the following nodes.
+    */
+    struct Writer
+    {
+        Writer(PrintBuffer* b, const PrintOptions& o);
+
+        /** Start a node with children, close it with End.
+        */
+        void BeginStruct(std::string_view name, std::string_view value);
+
+        /** Start a node with only values, add them with Value with a empty name and close it with End.
+        */
+        void BeginArray(std::string_view name);
+
+        /** A node without children.
+        */
+        void Value(std::string_view name, std::string_view value);
+
+        /** Close the last struct or array, returns false if nothing is open.
+        */
+        bool End();
+
+        /** The number of open structs and arrays.
+        */
+        std::size_t Depth() const;
+
+        void Begin(std::string_view name, std::string_view value);
+        void WriteHeader(std::size_t depth, std::string_view name, std::string_view value);
+        void WriteOpenHeader();
+
+        struct Open
+        {
+            std::string name;
+            std::string value;
+        };
+
+        PrintBuffer* buffer;
+        PrintOptions options;
+        IndentCache indents;
+        std::vector<Open> open;
+
+        /** The last open node hasn't been written yet, a node without children is printed without braces.
+        */
+        bool header_pending;
+    };
+}
@@ -0,0 +1,60 @@
+#include "catch.hpp"
+#include "catchy/stringeq.h"
+#include "infofile/infofile.h"
+#include "infofile/writer.h"
+
+using namespace infofile;
+
+namespace
+{
+    std::string PrintInline(const std::string& src, const PrintOptions& options)
+    {
+        std::vector<std::string> errors;
+        return PrintToString(options, Parse("inline", src, &errors));
+    }
+}
+
+TEST_CASE("writer", "[writer]")
+{
+    PrintOptions options;
+    std::string printed;
+
+    SECTION("same as printing a tree")
+    {
+        {
+            PrintBuffer buffer{StringSink(&printed)};
+            Writer writer{&buffer, options};
+            writer.BeginStruct("", "");
+            writer.Value("a", "b");
+            writer.BeginStruct("c", "d e");
+            writer.Value("f", "line\nbreak");
+            writer.BeginArray("g");
+            writer.Value("", "1");
+            writer.Value("", "2");
+            CHECK(3 == writer.Depth());
+            CHECK(writer.End());
+            CHECK(writer.End());
+            writer.BeginStruct("empty", "");
+            CHECK(writer.End());
+            CHECK(writer.End());
+            CHECK_FALSE(writer.End());
+        }
+        CHECK(catchy::StringEq(printed, PrintInline("a b; c \"d e\" { f \"line\\nbreak\"; g [1, 2] } empty", options)));
+    }
+
+    SECTION("options")
+    {
+        options.tab = "\t";
+        options.term = "";
+        {
+            PrintBuffer buffer{StringSink(&printed)};
+            Writer writer{&buffer, options};
+            writer.BeginStruct("", "");
+            writer.BeginStruct("a", "");
+            writer.Value("b", "c");
+            writer.End();
+            writer.End();
+        }
+        CHECK(catchy::StringEq(printed, "\"\" \"\" {\n\ta \"\" {\n\t\tb c\n\t}\n}\n"));
+    }
+}